@@ -0,0 +1,187 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "batchMeans.h"
+#include "checkpoint.h"
+#include <math.h>
+
+const double batchMeans::MAX_CORRELATION = 0.2;
+const char * batchMeans::METRIC_NAMES[NUM_METRICS] = { "Flit Latency", "Packet Latency", "Accepted Load" };
+
+batchMeans::batchMeans(long long batch_cycles) :
+		m_batchCycles(batch_cycles), m_batchStart(-1), m_precisionReached(false) {
+	assert(m_batchCycles > 0);
+	for (int metric = 0; metric < NUM_METRICS; metric++) {
+		m_sum[metric] = 0;
+		m_weight[metric] = 0;
+	}
+	m_batches.reserve(MAX_BATCHES);
+}
+
+/*
+ * Begins the first batch at current cycle, once warmup is over.
+ */
+void batchMeans::start() {
+	m_batchStart = g_cycle;
+}
+
+/*
+ * Stores the batch that ends in current cycle, merging batches if their
+ * maximum number is reached. Returns true once the intervals of all the
+ * configured metrics are within the target relative half-width, and the
+ * batch means are not significantly correlated.
+ */
+bool batchMeans::closeBatch() {
+	batch current;
+	double mean, half_width;
+	unsigned int i;
+	int metric;
+
+	m_sum[ACCEPTED_LOAD] = m_weight[FLIT_LATENCY] * g_flit_size;
+	m_weight[ACCEPTED_LOAD] = 1.0 * g_number_generators * (g_cycle - m_batchStart);
+	for (metric = 0; metric < NUM_METRICS; metric++) {
+		current.sum[metric] = m_sum[metric];
+		current.weight[metric] = m_weight[metric];
+		m_sum[metric] = 0;
+		m_weight[metric] = 0;
+	}
+	m_batches.push_back(current);
+	m_batchStart = g_cycle;
+
+	if (m_batches.size() == MAX_BATCHES) {
+		for (i = 0; i < MAX_BATCHES / 2; i++) {
+			for (metric = 0; metric < NUM_METRICS; metric++) {
+				m_batches[i].sum[metric] = m_batches[2 * i].sum[metric] + m_batches[2 * i + 1].sum[metric];
+				m_batches[i].weight[metric] = m_batches[2 * i].weight[metric] + m_batches[2 * i + 1].weight[metric];
+			}
+		}
+		m_batches.resize(MAX_BATCHES / 2);
+		m_batchCycles *= 2;
+	}
+
+	m_precisionReached = true;
+	for (i = 0; i < g_ci_metrics.size(); i++) {
+		if (getInterval(g_ci_metrics[i], mean, half_width) < MIN_BATCHES || mean <= 0
+				|| half_width / mean > g_ci_target || getCorrelation(g_ci_metrics[i]) > MAX_CORRELATION)
+			m_precisionReached = false;
+	}
+	return m_precisionReached;
+}
+
+/*
+ * Means of a metric in every batch; batches without any observation
+ * (e.g., no packets received at very low loads) are left out.
+ */
+void batchMeans::batchMeanValues(int metric, vector<double> &values) const {
+	values.clear();
+	for (unsigned int i = 0; i < m_batches.size(); i++)
+		if (m_batches[i].weight[metric] > 0) values.push_back(m_batches[i].sum[metric] / m_batches[i].weight[metric]);
+}
+
+/*
+ * 95% confidence interval of a metric, as mean +- half_width. Returns
+ * the number of batches it has been estimated from.
+ */
+int batchMeans::getInterval(int metric, double &mean, double &half_width) const {
+	vector<double> values;
+	double variance = 0;
+	int i, n;
+
+	batchMeanValues(metric, values);
+	n = values.size();
+	mean = 0;
+	half_width = 0;
+	if (n == 0) return 0;
+	for (i = 0; i < n; i++)
+		mean += values[i];
+	mean /= n;
+	if (n == 1) return n;
+	for (i = 0; i < n; i++)
+		variance += (values[i] - mean) * (values[i] - mean);
+	variance /= n - 1;
+	half_width = tQuantile(n - 1) * sqrt(variance / n);
+	return n;
+}
+
+/*
+ * Lag-1 autocorrelation of the batch means of a metric; a high value
+ * reveals batches too short to be taken as independent observations.
+ */
+double batchMeans::getCorrelation(int metric) const {
+	vector<double> values;
+	double mean = 0, covariance = 0, variance = 0;
+	int i, n;
+
+	batchMeanValues(metric, values);
+	n = values.size();
+	if (n < 2) return 0;
+	for (i = 0; i < n; i++)
+		mean += values[i];
+	mean /= n;
+	for (i = 0; i < n; i++) {
+		variance += (values[i] - mean) * (values[i] - mean);
+		if (i > 0) covariance += (values[i] - mean) * (values[i - 1] - mean);
+	}
+	return (variance > 0) ? covariance / variance : 0;
+}
+
+/*
+ * Two-sided 95% quantile of the Student's t distribution.
+ */
+double batchMeans::tQuantile(int degrees) {
+	static const double quantiles[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201,
+			2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056,
+			2.052, 2.048, 2.045, 2.042, 2.040 };
+	static const int entries = sizeof(quantiles) / sizeof(quantiles[0]);
+
+	assert(degrees > 0);
+	return (degrees <= entries) ? quantiles[degrees - 1] : 1.96;
+}
+
+void batchMeans::writeOutput(ostream &output) const {
+	double mean, half_width;
+	int metric, batches;
+
+	output << "Confidence Intervals (95%, batch means): " << getBatches() << " batches, last of " << m_batchCycles
+			<< " cycles" << endl;
+	if (m_precisionReached)
+		output << "CI Precision: target " << g_ci_target * 100 << "% reached at cycle " << g_cycle << endl;
+	else
+		output << "CI Precision: target " << g_ci_target * 100 << "% not reached" << endl;
+	for (metric = 0; metric < NUM_METRICS; metric++) {
+		batches = getInterval(metric, mean, half_width);
+		output << "CI " << METRIC_NAMES[metric] << ": ";
+		if (batches < 2)
+			output << "not enough batches";
+		else
+			output << mean << " +- " << half_width << " (" << (mean > 0 ? 100 * half_width / mean : 0)
+					<< "%, lag-1 correlation " << getCorrelation(metric) << ")";
+		output << endl;
+	}
+}
+
+void batchMeans::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(m_batchCycles);
+	ckpt.value(m_batchStart);
+	ckpt.array(m_sum, NUM_METRICS);
+	ckpt.array(m_weight, NUM_METRICS);
+	ckpt.vect(m_batches);
+	ckpt.value(m_precisionReached);
+}
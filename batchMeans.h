@@ -0,0 +1,88 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BATCHMEANS_H
+#define	BATCHMEANS_H
+
+#include "global.h"
+
+class checkpointFile;
+
+/*
+ * Batch-means estimator of the confidence intervals of the measured
+ * statistics, to end simulation once they are precise enough. Time
+ * after warmup is split into batches of consecutive cycles, and the
+ * mean of each metric within a batch is taken as one observation.
+ * Batches are merged pairwise when MAX_BATCHES are complete (and their
+ * length doubled), so the number of batches stays bounded while they
+ * grow long enough to be nearly independent.
+ */
+class batchMeans {
+public:
+	batchMeans(long long batch_cycles);
+	/* Called on every flit consumed after warmup */
+	inline void record(long double flit_latency, bool tail, long double packet_latency) {
+		m_sum[FLIT_LATENCY] += flit_latency;
+		m_weight[FLIT_LATENCY]++;
+		if (tail) {
+			m_sum[PACKET_LATENCY] += packet_latency;
+			m_weight[PACKET_LATENCY]++;
+		}
+	}
+	inline bool isBatchDue() const {
+		return m_batchStart >= 0 && g_cycle - m_batchStart >= m_batchCycles;
+	}
+	void start();
+	bool closeBatch();
+	int getInterval(int metric, double &mean, double &half_width) const;
+	double getCorrelation(int metric) const;
+	int getBatches() const {
+		return m_batches.size();
+	}
+	long long getBatchCycles() const {
+		return m_batchCycles;
+	}
+	bool isPrecisionReached() const {
+		return m_precisionReached;
+	}
+	void writeOutput(ostream &output) const;
+	void checkpoint(checkpointFile &ckpt);
+	static double tQuantile(int degrees);
+	static const int NUM_METRICS = ACCEPTED_LOAD + 1;
+	static const int MIN_BATCHES = 10;
+	static const int MAX_BATCHES = 32;
+	static const double MAX_CORRELATION;
+	static const char * METRIC_NAMES[NUM_METRICS];
+private:
+	/* Observation of a batch: metric mean is sum / weight */
+	struct batch {
+		long double sum[NUM_METRICS];
+		double weight[NUM_METRICS];
+	};
+	long long m_batchCycles;
+	long long m_batchStart; /* First cycle of current batch (-1 before measurement starts) */
+	long double m_sum[NUM_METRICS]; /* Accumulators of current batch */
+	double m_weight[NUM_METRICS];
+	vector<batch> m_batches;
+	bool m_precisionReached;
+	void batchMeanValues(int metric, vector<double> &values) const;
+};
+
+#endif	/* BATCHMEANS_H */
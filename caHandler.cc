@@ -21,6 +21,7 @@
 #include "caHandler.h"
 #include "switch/switchModule.h"
 #include "flit/flitModule.h"
+#include "checkpoint.h"
 
 caHandler::caHandler(switchModule * sw) {
 	int i, port, group;
@@ -298,3 +299,16 @@ void caHandler::decreaseContention(int port) {
 	assert(m_contention_counter[port] >= 0);
 	assert(!g_increaseContentionAtHeader);
 }
+
+void caHandler::checkpoint(checkpointFile &ckpt) {
+	int i;
+	ckpt.array(m_contention_counter, g_ports);
+	ckpt.array(m_potential_contention_counter, g_ports);
+	ckpt.array(m_accumulated_contention, g_ports);
+	for (i = 0; i < g_a_routers_per_group; i++)
+		ckpt.array(m_partial_counter[i], g_a_routers_per_group * g_h_global_ports_per_router + 1);
+	for (i = 0; i < g_ports; i++)
+		ckpt.fifo(m_sending_end_cycle_queue[i]);
+	for (i = 0; i < g_a_routers_per_group * g_h_global_ports_per_router + 1; i++)
+		ckpt.fifo(m_sending_end_cycle_globalport_queue[i]);
+}
@@ -25,6 +25,7 @@
 #include <queue>
 
 class flitModule;
+class checkpointFile;
 
 class caHandler {
 public:
@@ -39,6 +40,7 @@ public:
 	void decreaseContention(int port);
 	void updateContention(int output);
 	void readIncomingCAFlits();
+	void checkpoint(checkpointFile &ckpt);
 private:
 	/* Counts number of PHITS that would
 	 * be minimally routed through each port
@@ -0,0 +1,402 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "checkpoint.h"
+#include "histogram.h"
+#include "flit/flitModule.h"
+#include "flit/pbFlit.h"
+#include "flit/caFlit.h"
+#include "switch/switchModule.h"
+#include "generator/generatorModule.h"
+#include "batchMeans.h"
+#include <stdio.h>
+#include <sstream>
+#include <iostream>
+#include <type_traits>
+
+#define CHECKPOINT_MAGIC 0x54504b43474f46LL /* "FOGCKPT" */
+#define CHECKPOINT_VERSION 4
+
+/* Flits are stored as a raw copy of their contents */
+static_assert(is_trivially_copyable<flitModule>::value, "flitModule must remain trivially copyable");
+
+/* Parameters that may change between the run that stores a checkpoint and the runs restored from it */
+static const char * g_checkpoint_run_parameters[] = { "Probability", "MaxCycles", "OutputFileName", "PrintCycles",
+		"PrintProgress", "PrintInterval", "SampleCycles", "SampleBufferLength", "PrintHists", "ResultsFormat",
+		"ResultsFile", "VerboseSwitches", "VerboseCycles", "PacketTrace", "PacketTraceBufferLength",
+		"PacketTracePackets", "PacketTraceGroups", "PacketTraceSwitches", "Profile", "CheckpointSave",
+		"CheckpointInterval", "CheckpointRestore", "SteadyStateWindow", "CITarget", "CIBatchCycles", "CIMetrics",
+		"CompactTables", "MemoryBudget" };
+
+checkpointFile::checkpointFile(const char * file_name, bool restoring) :
+		m_fileName(file_name), m_restoring(restoring) {
+	if (m_restoring) {
+		m_file = gzopen(m_fileName.c_str(), "rb");
+	} else {
+		m_tmpFileName = m_fileName + ".tmp";
+		m_file = gzopen(m_tmpFileName.c_str(), "wb1");
+	}
+	if (m_file == NULL) {
+		cerr << "Can't open the checkpoint file: " << (m_restoring ? m_fileName : m_tmpFileName) << endl;
+		exit(-1);
+	}
+	gzbuffer(m_file, 1 << 20);
+}
+
+checkpointFile::~checkpointFile() {
+	if (m_file != NULL) gzclose(m_file);
+}
+
+void checkpointFile::data(void * data, size_t length) {
+	char * bytes = (char *) data;
+	while (length > 0) {
+		unsigned chunk = (length > (1U << 30)) ? (1U << 30) : length;
+		int done = m_restoring ? gzread(m_file, bytes, chunk) : gzwrite(m_file, bytes, chunk);
+		if (done != (int) chunk) {
+			cerr << "ERROR: checkpoint file " << (m_restoring ? m_fileName : m_tmpFileName)
+					<< (m_restoring ? " is truncated or corrupt" : " could not be written") << endl;
+			exit(-1);
+		}
+		bytes += chunk;
+		length -= chunk;
+	}
+}
+
+void checkpointFile::text(string &text) {
+	long long length = text.size();
+	value(length);
+	if (m_restoring) text.resize(length);
+	if (length > 0) data(&text[0], length);
+}
+
+/*
+ * Flits are owned by the buffer holding them, so they are stored in full;
+ * when restoring, a new flit is allocated for every one that was stored.
+ */
+void checkpointFile::flit(flitModule* &flit) {
+	bool present = (flit != NULL);
+	value(present);
+	if (m_restoring) flit = present ? new flitModule(0, 0, 0, 0, 0, 0, 0, false, false) : NULL;
+	if (present) data(flit, sizeof(flitModule));
+}
+
+/*
+ * Completes the checkpoint file. When writing, it is only put in place
+ * (replacing any previous one) once it has been completely stored.
+ */
+void checkpointFile::close() {
+	int result = gzclose(m_file);
+	m_file = NULL;
+	if (result != Z_OK) {
+		cerr << "ERROR: checkpoint file " << (m_restoring ? m_fileName : m_tmpFileName)
+				<< (m_restoring ? " is truncated or corrupt" : " could not be written") << endl;
+		exit(-1);
+	}
+	if (!m_restoring && rename(m_tmpFileName.c_str(), m_fileName.c_str()) != 0) {
+		cerr << "ERROR: checkpoint file " << m_tmpFileName << " could not be renamed into " << m_fileName << endl;
+		exit(-1);
+	}
+}
+
+/*
+ * Aborts if the simulation employs any feature whose state is not
+ * stored in checkpoints.
+ */
+void checkCheckpointSupport() {
+	const char * feature = NULL;
+
+	if (g_traffic == TRACE) feature = "trace traffic";
+	if (g_traffic == GRAPH500) feature = "Graph500 traffic";
+	if (g_traffic == ALL2ALL || g_traffic == SINGLE_BURST) feature = "all-to-all or single burst traffic";
+	if (g_congestion_management == QCNSW) feature = "QCN congestion management";
+	if (g_deadlock_avoidance == RING) feature = "physical rings";
+	if (feature != NULL) {
+		cerr << "ERROR: checkpoints are not supported with " << feature << endl;
+		exit(-1);
+	}
+}
+
+/*
+ * Checkpoint header: format version, sanity values and the parameters of the
+ * simulation that stored it. When restoring, these must match current ones,
+ * but for those parameters that do not affect the state of the network.
+ */
+static void checkpointHeader(checkpointFile &ckpt) {
+	long long magic = CHECKPOINT_MAGIC, size;
+	int version = CHECKPOINT_VERSION, flit_size = sizeof(flitModule);
+	map<string, string> parameters(g_config_parameters), stored;
+	map<string, string>::iterator it;
+	string key, value;
+	unsigned int i;
+
+	ckpt.value(magic);
+	ckpt.value(version);
+	if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+		cerr << "ERROR: not a checkpoint file, or unsupported checkpoint version" << endl;
+		exit(-1);
+	}
+	ckpt.value(flit_size);
+	if (flit_size != sizeof(flitModule)) {
+		cerr << "ERROR: checkpoint was stored by an incompatible simulator build" << endl;
+		exit(-1);
+	}
+
+	for (i = 0; i < sizeof(g_checkpoint_run_parameters) / sizeof(g_checkpoint_run_parameters[0]); i++)
+		parameters.erase(g_checkpoint_run_parameters[i]);
+	size = parameters.size();
+	ckpt.value(size);
+	if (!ckpt.isRestoring()) {
+		for (it = parameters.begin(); it != parameters.end(); ++it) {
+			key = it->first;
+			value = it->second;
+			ckpt.text(key);
+			ckpt.text(value);
+		}
+		return;
+	}
+	for (; size > 0; size--) {
+		ckpt.text(key);
+		ckpt.text(value);
+		stored[key] = value;
+	}
+	for (it = stored.begin(); it != stored.end(); ++it)
+		if (parameters.count(it->first) == 0 || parameters[it->first] != it->second) {
+			cerr << "ERROR: checkpoint was stored with " << it->first << "=" << it->second << ", but current value is '"
+					<< parameters[it->first] << "'" << endl;
+			exit(-1);
+		}
+	for (it = parameters.begin(); it != parameters.end(); ++it)
+		if (stored.count(it->first) == 0) {
+			cerr << "ERROR: parameter " << it->first << " was not in use when checkpoint was stored" << endl;
+			exit(-1);
+		}
+}
+
+/*
+ * Random number generators. rand() state is switched away before being
+ * restored, since setstate() saves the position of the current state.
+ */
+static void checkpointRandomState(checkpointFile &ckpt) {
+	static int32_t aux_state[32];
+	string engine;
+
+	if (ckpt.isRestoring()) {
+		initstate(1, (char *) aux_state, sizeof(aux_state));
+		ckpt.array(g_rand_state, 32);
+		setstate((char *) g_rand_state);
+	} else {
+		setstate((char *) g_rand_state);
+		ckpt.array(g_rand_state, 32);
+	}
+
+	if (!ckpt.isRestoring()) {
+		ostringstream text;
+		text << g_reng;
+		engine = text.str();
+	}
+	ckpt.text(engine);
+	if (ckpt.isRestoring()) {
+		istringstream text(engine);
+		text >> g_reng;
+	}
+}
+
+/* Statistics and counters kept in global variables */
+static void checkpointStatistics(checkpointFile &ckpt) {
+	int i, p;
+
+	ckpt.value(g_flit_latency);
+	ckpt.value(g_packet_latency);
+	ckpt.value(g_injection_queue_latency);
+	ckpt.value(g_base_latency);
+	ckpt.value(g_warmup_flit_latency);
+	ckpt.value(g_warmup_packet_latency);
+	ckpt.value(g_warmup_injection_latency);
+	ckpt.value(g_response_latency);
+	if (g_transient_stats) {
+		ckpt.array(g_transient_record_latency, g_transient_record_len);
+		ckpt.array(g_transient_record_injection_latency, g_transient_record_len);
+		ckpt.array(g_transient_record_flits, g_transient_record_len);
+		ckpt.array(g_transient_record_misrouted_flits, g_transient_record_len);
+		ckpt.array(g_transient_net_injection_latency, g_transient_record_len);
+		ckpt.array(g_transient_net_injection_inj_latency, g_transient_record_len);
+		ckpt.array(g_transient_net_injection_flits, g_transient_record_len);
+		ckpt.array(g_transient_net_injection_misrouted_flits, g_transient_record_len);
+	}
+	for (i = 0; i < g_a_routers_per_group; i++) {
+		for (p = 0; p < g_p_computing_nodes_per_router; p++)
+			ckpt.array(g_group0_numFlits[i][p], 2);
+		ckpt.value(g_group0_totalLatency[i]);
+		ckpt.value(g_groupRoot_numFlits[i]);
+		ckpt.value(g_groupRoot_totalLatency[i]);
+	}
+	/* Per-cycle ACOR records are only stored up to the checkpoint cycle, as run length may change */
+	if (g_routing == ACOR || g_routing == PB_ACOR) {
+		for (i = 0; i < g_a_routers_per_group; i++) {
+			ckpt.array(g_acor_group0_sws_packets_blocked[i], g_cycle);
+			if (g_acor_state_management == SWITCHCGCSRS || g_acor_state_management == SWITCHCGRS
+					|| g_acor_state_management == SWITCHCSRS) ckpt.array(g_acor_group0_sws_status[i], g_cycle);
+		}
+	}
+	/* Batch means may be enabled for a run restored from a warmup checkpoint, but not halfway */
+	bool batch_means = (g_batch_means != NULL);
+	ckpt.value(batch_means);
+	if (batch_means) {
+		batchMeans discarded(1);
+		(g_batch_means != NULL ? g_batch_means : &discarded)->checkpoint(ckpt);
+	} else if (g_batch_means != NULL && g_cycle > g_warmup_cycles) {
+		cerr << "ERROR: checkpoint taken after warmup lacks the batch means required by CITarget" << endl;
+		exit(-1);
+	}
+	ckpt.value(g_latency_histogram_maxLat);
+	g_latency_histogram_no_global_misroute->checkpoint(ckpt);
+	g_latency_histogram_global_misroute_at_injection->checkpoint(ckpt);
+	g_latency_histogram_other_global_misroute->checkpoint(ckpt);
+	g_injection_latency_histogram->checkpoint(ckpt);
+	ckpt.value(g_hops_histogram_maxHops);
+	g_hops_histogram->checkpoint(ckpt);
+
+	ckpt.value(g_tx_flit_counter);
+	ckpt.value(g_tx_cnmFlit_counter);
+	ckpt.value(g_tx_flit_counter_printC);
+	ckpt.value(g_rx_flit_counter);
+	ckpt.value(g_rx_cnmFlit_counter);
+	ckpt.array(g_rx_acorState_counter, RRGLSw + 1);
+	ckpt.value(g_rx_flit_counter_printC);
+	ckpt.value(g_attended_flit_counter);
+	ckpt.value(g_tx_warmup_flit_counter);
+	ckpt.value(g_tx_warmup_cnmFlit_counter);
+	ckpt.value(g_rx_warmup_flit_counter);
+	ckpt.value(g_rx_warmup_cnmFlit_counter);
+	ckpt.array(g_rx_warmup_acorState_counter, RRGLSw + 1);
+	ckpt.value(g_response_counter);
+	ckpt.value(g_response_warmup_counter);
+	ckpt.value(g_nonminimal_counter);
+	ckpt.value(g_nonminimal_warmup_counter);
+	ckpt.value(g_nonminimal_inj);
+	ckpt.value(g_nonminimal_warmup_inj);
+	ckpt.value(g_nonminimal_src);
+	ckpt.value(g_nonminimal_warmup_src);
+	ckpt.value(g_nonminimal_int);
+	ckpt.value(g_nonminimal_warmup_int);
+	ckpt.array(g_min_flit_counter, g_allocator_iterations);
+	ckpt.array(g_global_misrouted_flit_counter, g_allocator_iterations);
+	ckpt.array(g_global_mandatory_misrouted_flit_counter, g_allocator_iterations);
+	ckpt.array(g_local_misrouted_flit_counter, g_allocator_iterations);
+	ckpt.value(g_tx_packet_counter);
+	ckpt.value(g_rx_packet_counter);
+	ckpt.value(g_tx_warmup_packet_counter);
+	ckpt.value(g_rx_warmup_packet_counter);
+	ckpt.value(g_injected_packet_counter);
+	ckpt.value(g_injected_bursts_counter);
+
+	ckpt.value(g_total_hop_counter);
+	ckpt.value(g_local_hop_counter);
+	ckpt.value(g_global_hop_counter);
+	ckpt.value(g_local_ring_hop_counter);
+	ckpt.value(g_global_ring_hop_counter);
+	ckpt.value(g_local_tree_hop_counter);
+	ckpt.value(g_global_tree_hop_counter);
+	ckpt.value(g_max_hops);
+	ckpt.value(g_max_local_hops);
+	ckpt.value(g_max_global_hops);
+	ckpt.value(g_max_local_subnetwork_hops);
+	ckpt.value(g_max_global_subnetwork_hops);
+	ckpt.value(g_max_local_ring_hops);
+	ckpt.value(g_max_global_ring_hops);
+	ckpt.value(g_max_local_tree_hops);
+	ckpt.value(g_max_global_tree_hops);
+
+	ckpt.array(g_port_usage_counter, g_ports);
+	ckpt.array(g_port_contention_counter, g_ports);
+	for (i = 0; i < g_vc_counter.size(); i++)
+		ckpt.vect(g_vc_counter[i]);
+	ckpt.value(g_subnetwork_injections_counter);
+	ckpt.value(g_root_subnetwork_injections_counter);
+	ckpt.value(g_source_subnetwork_injections_counter);
+	ckpt.value(g_dest_subnetwork_injections_counter);
+	ckpt.value(g_max_subnetwork_injections);
+	ckpt.value(g_max_root_subnetwork_injections);
+	ckpt.value(g_max_source_subnetwork_injections);
+	ckpt.value(g_max_dest_subnetwork_injections);
+	ckpt.value(g_local_contention_counter);
+	ckpt.value(g_global_contention_counter);
+	ckpt.value(g_local_escape_contention_counter);
+	ckpt.value(g_global_escape_contention_counter);
+	ckpt.value(g_petitions);
+	ckpt.value(g_served_petitions);
+	ckpt.value(g_injection_petitions);
+	ckpt.value(g_served_injection_petitions);
+}
+
+/* Whole simulator state, in the same order for storing and restoring */
+static void checkpointState(checkpointFile &ckpt) {
+	long long magic = CHECKPOINT_MAGIC;
+	/* Length of the per-cycle records, as allocated for this run */
+	long long record_cycles = g_max_cycles + g_warmup_cycles;
+	int i;
+
+	checkpointHeader(ckpt);
+	ckpt.value(g_cycle);
+	ckpt.value(g_internal_cycle);
+	/* Warmup may have been ended by the steady-state detector */
+	ckpt.value(g_warmup_cycles);
+	/* Check the restored cycle before any per-cycle record is restored up to it */
+	if (ckpt.isRestoring()
+			&& (g_cycle < g_warmup_cycles || g_cycle > g_warmup_cycles + g_max_cycles || g_cycle > record_cycles)) {
+		cerr << "ERROR: checkpoint cycle " << g_cycle << " is out of the simulated range (WarmupCycles="
+				<< g_warmup_cycles << ", MaxCycles=" << g_max_cycles << ")" << endl;
+		exit(-1);
+	}
+	checkpointRandomState(ckpt);
+	for (i = 0; i < g_number_switches; i++)
+		g_switches_list[i]->checkpoint(ckpt);
+	for (i = 0; i < g_number_generators; i++)
+		g_generators_list[i]->checkpoint(ckpt);
+	/* Message ids go last, as restoring the messages on flight bumps them */
+	ckpt.value(pbFlit::id);
+	ckpt.value(caFlit::id);
+	checkpointStatistics(ckpt);
+
+	/* Trailer, to detect truncated files */
+	ckpt.value(magic);
+	if (magic != CHECKPOINT_MAGIC) {
+		cerr << "ERROR: checkpoint file is corrupt" << endl;
+		exit(-1);
+	}
+}
+
+void writeCheckpoint(const char * file_name) {
+	checkpointFile ckpt(file_name, false);
+	checkpointState(ckpt);
+	ckpt.close();
+	cout << "Checkpoint stored at cycle " << g_cycle << " into " << file_name << endl;
+}
+
+/*
+ * Restores the state of the simulation, which must have been created
+ * beforehand with the same configuration (see checkpointHeader()).
+ */
+void readCheckpoint(const char * file_name) {
+	checkpointFile ckpt(file_name, true);
+	checkpointState(ckpt);
+	ckpt.close();
+	cout << "Checkpoint restored from " << file_name << " at cycle " << g_cycle << endl;
+}
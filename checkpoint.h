@@ -0,0 +1,91 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CHECKPOINT_H
+#define	CHECKPOINT_H
+
+#include "global.h"
+#include <queue>
+#include <string>
+#include <zlib.h>
+
+class flitModule;
+
+/*
+ * Compressed binary file holding a snapshot of the simulator state.
+ * The same checkpoint() methods are employed to store and to load
+ * back the state of every module: depending on the mode the file is
+ * opened with, each call either writes the given variable or
+ * overwrites it with the stored value. Modules must therefore visit
+ * their state in the same order in both cases, and only store data
+ * that does not point elsewhere (flits are copied in full).
+ */
+class checkpointFile {
+public:
+	checkpointFile(const char * file_name, bool restoring);
+	~checkpointFile();
+	inline bool isRestoring() const {
+		return m_restoring;
+	}
+	void data(void * data, size_t length);
+	template<class T> inline void value(T &value) {
+		data(&value, sizeof(T));
+	}
+	template<class T> inline void array(T * values, long long count) {
+		data(values, sizeof(T) * count);
+	}
+	template<class T> void vect(vector<T> &values);
+	template<class T> void fifo(queue<T> &values);
+	void text(string &text);
+	void flit(flitModule* &flit);
+	void close();
+private:
+	string m_fileName;
+	string m_tmpFileName; /* Checkpoints are written aside, and renamed once complete */
+	bool m_restoring;
+	gzFile m_file;
+};
+
+template<class T> void checkpointFile::vect(vector<T> &values) {
+	long long size = values.size();
+	value(size);
+	if (m_restoring) values.resize(size);
+	if (size > 0) array(values.data(), size);
+}
+
+template<class T> void checkpointFile::fifo(queue<T> &values) {
+	long long size = values.size();
+	value(size);
+	for (long long i = 0; i < size; i++) {
+		T item;
+		if (!m_restoring) {
+			item = values.front();
+			values.pop();
+		}
+		value(item);
+		values.push(item);
+	}
+}
+
+void checkCheckpointSupport();
+void writeCheckpoint(const char * file_name);
+void readCheckpoint(const char * file_name);
+
+#endif	/* CHECKPOINT_H */
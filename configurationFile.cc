@@ -128,6 +128,18 @@ int ConfigFile::getKeyValue(const char *section, const char *key, string &value)
 	return 0;
 }
 
+/* Returns a copy of all single-valued keys within a section */
+int ConfigFile::getKeyEntries(const char *section, keyEntries &entries) {
+	string section_ = section;
+
+	if (sectionEntries.count(section_)) {
+		entries = sectionEntries[section_]->keyEntry;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
 int ConfigFile::LoadConfig(string fileName) {
 	fstream confFile;
 	vector < string > lines;
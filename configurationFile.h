@@ -57,6 +57,7 @@ public:
 	int LoadConfig(string fileName);
 	int getListValues(const char *section, const char *key, vector<string> &value);
 	int getKeyValue(const char *section, const char *key, string &value);
+	int getKeyEntries(const char *section, keyEntries &entries);
 	int updateKeyValue(const char *section, char *line);
 	int checkSection(const char *section);
 	void flushConfig(void);
@@ -21,9 +21,21 @@
 #include "dgflySimulator.h"
 #include "global.h"
 #include "configurationFile.h"
+#include "histogram.h"
+#include "resultRecord.h"
+#include "metricsSampler.h"
+#include "packetTracer.h"
+#include "phaseProfiler.h"
+#include "checkpoint.h"
+#include "sweep.h"
+#include "steadyStateDetector.h"
+#include "batchMeans.h"
+#include "memoryPlanner.h"
 #include "generator/generatorModule.h"
 #include "generator/burstGenerator.h"
 #include "generator/traceGenerator.h"
+#include "generator/traceScheduler.h"
+#include "generator/tracePrefetcher.h"
 #include "generator/graph500Generator.h"
 #include "switch/ioqSwitchModule.h"
 #include <math.h>
@@ -31,6 +43,8 @@
 #include <iomanip>
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <algorithm>
 using namespace std;
 
 int module(int a, int b) {
@@ -47,6 +61,9 @@ bool parity(int a, int b) {
 	return (p);
 }
 
+/* The trace converter (see traceConverter.cc) reuses the configuration
+ * and trace readers, with its own entry point. */
+#ifndef TRACE_CONVERTER
 int main(int argc, char *argv[]) {
 	int i, j;
 
@@ -58,16 +75,17 @@ int main(int argc, char *argv[]) {
 
 	/* Read parameters in config file */
 	readConfiguration(argc, argv);
-	srand(g_seed);
+	/* Same sequence as srand(), but rand() state lies in a buffer of our own so it can be checkpointed */
+	initstate(g_seed, (char *) g_rand_state, sizeof(g_rand_state));
 	g_reng.seed(g_seed);
 
-	/* Open output file */
-	g_output_file.open(g_output_file_name, ios::out);
-	if (!g_output_file) {
-		cerr << "Can't open the output file" << g_output_file_name << endl;
-		exit(-1);
-	}
-	g_output_file.close();
+	/* Sweeps over parameters that shape the network run every value from scratch */
+	if (g_sweep_key != NULL && !sweepSharesNetwork()) runSweep(argc, argv);
+	/* So does every run of a batch */
+	if (!g_batch_axes.empty()) runBatch(argc, argv);
+
+	/* Open output file; runs forked by sweeps and branching open their own */
+	if (g_sweep_key == NULL && g_branch_variants.empty()) openOutputFile();
 
 	createNetwork();
 
@@ -77,12 +95,11 @@ int main(int argc, char *argv[]) {
 
 	/* Read/translate trace-related files */
 	if (g_traffic == TRACE) {
+		g_trace_scheduler = new traceScheduler(g_number_generators);
 		for (i = 0; i < g_num_traces; i++) {
 			/* read_trace() receives a vector of trace instances to
 			 * load. For first initialization, all trace instances
 			 * must be load at once. */
-			translate_pcf_file(i);
-
 			vector<int> instances;
 			for (j = 0; j < g_trace_instances[i]; j++)
 				instances.push_back(j);
@@ -90,8 +107,34 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	/* Otherwise, processes simulating every value are forked once the network is ready */
+	if (g_sweep_key != NULL) {
+		runSweep(argc, argv);
+		openOutputFile();
+	}
+
+	if (g_packet_trace) g_packet_tracer = new packetTracer(g_number_switches, g_packet_trace_buffer_length);
+
+	/* Metrics time series is written to a side file by a background thread */
+	if (g_sample_cycles > 0) {
+		string metrics_file_name(g_output_file_name);
+		metrics_file_name.append(".metrics");
+		g_metrics_sampler = new metricsSampler(metrics_file_name.c_str(), g_sample_cycles, g_sample_buffer_length);
+	}
+
+	if (g_profile) g_profiler = new phaseProfiler();
+
 	/* Run simulation */
+	if (g_profile) g_profiler->startRun();
 	action();
+	if (g_profile) g_profiler->endRun();
+
+	if (g_metrics_sampler != NULL) g_metrics_sampler->close();
+	if (g_packet_trace) {
+		string trace_file_name(g_output_file_name);
+		trace_file_name.append(".trace.json");
+		g_packet_tracer->exportChromeTrace(trace_file_name.c_str());
+	}
 
 	/* Write results into output file */
 	for (i = 0; i < g_number_switches; i++) {
@@ -118,11 +161,16 @@ int main(int argc, char *argv[]) {
 	}
 	assert(g_min_injection_packets_per_sw <= g_max_injection_packets_per_sw);
 	assert(g_min_injection_cnmPackets_per_sw <= g_max_injection_cnmPackets_per_sw);
+	for (i = 0; i < g_number_switches; i++)
+		g_switches_list[i]->setQueueOccupancy();
+
 	cout << "Write output" << endl;
-	writeOutput();
+	if (g_results_format != TEXT) writeResultRecord(g_results_file_name);
+	if (g_results_format != JSONL) writeOutput();
 
 	if (g_print_hists) {
 		writeLatencyHistogram(g_output_file_name);
+		writeInjectionLatencyHistogram(g_output_file_name);
 		writeHopsHistogram(g_output_file_name);
 		writeGeneratorsInjectionProbability(g_output_file_name);
 		if (g_congestion_management == QCNSW) if (g_qcn_transient_stats) {
@@ -138,6 +186,20 @@ int main(int argc, char *argv[]) {
                 g_acor_state_management == SWITCHCSRS) 
             writeAcorGroup0SwsStatus(g_output_file_name);
     }
+	if (g_profile) {
+		string profile_file_name(g_output_file_name);
+		profile_file_name.append(".profile");
+		ofstream profile_file(profile_file_name.c_str(), ios::out | ios::trunc);
+		if (!profile_file) {
+			cerr << "Can't open the profile file: " << profile_file_name << endl;
+			exit(-1);
+		}
+		g_profiler->writeReport(profile_file);
+		g_profiler->writeReport(cout);
+	}
+
+	/* Runs within a saturation search report back their accepted load */
+	if (g_saturation_search || g_replications > 0) reportSweepRun();
 
 	freeMemory();
 
@@ -145,6 +207,19 @@ int main(int argc, char *argv[]) {
 
 	return 0;
 }
+#endif
+
+/* Checks that the output file can be written, so as not to fail once the simulation is over */
+void openOutputFile() {
+	if (g_results_format != JSONL) {
+		g_output_file.open(g_output_file_name, ios::out);
+		if (!g_output_file) {
+			cerr << "Can't open the output file" << g_output_file_name << endl;
+			exit(-1);
+		}
+		g_output_file.close();
+	}
+}
 
 /* 
  * Reads config parameters from config file.
@@ -176,6 +251,140 @@ void readConfiguration(int argc, char *argv[]) {
 		}
 	}
 
+	/* Sweep: one parameter takes a list (or range) of values, each one simulated as a separate run */
+	if (config.getKeyValue("CONFIG", "SweepKey", value) == 0 && value.length() > 0) {
+		g_sweep_key = new char[value.length() + 1];
+		strcpy(g_sweep_key, value.c_str());
+		if (config.getListValues("CONFIG", "SweepValues", list_values) == 0) {
+			g_sweep_values = list_values;
+		} else if (config.getKeyValue("CONFIG", "SweepValues", value) == 0) {
+			/* Command line values are not split into lists */
+			istringstream values(value);
+			while (getline(values, value, ','))
+				g_sweep_values.push_back(value);
+		} else if (config.getKeyValue("CONFIG", "SweepRange", value) == 0) {
+			double first, last, step;
+			if (sscanf(value.c_str(), "%lf:%lf:%lf", &first, &last, &step) != 3 || step <= 0) {
+				cerr << "ERROR: SweepRange must be given as first:last:step" << endl;
+				exit(-1);
+			}
+			for (i = 0; first + i * step <= last + step * 1e-6; i++) {
+				ostringstream sweep_value;
+				sweep_value << first + i * step;
+				g_sweep_values.push_back(sweep_value.str());
+			}
+		}
+		if (g_sweep_values.empty()) {
+			cerr << "ERROR: SweepKey requires a list of values (SweepValues) or a range (SweepRange)" << endl;
+			exit(-1);
+		}
+		/* Swept parameter may be left out of the configuration; first value is employed to read it */
+		if (config.getKeyValue("CONFIG", g_sweep_key, value) != 0) {
+			value = string(g_sweep_key) + "=" + g_sweep_values[0];
+			config.updateKeyValue("CONFIG", &value[0]);
+		}
+	}
+	/* Saturation search: injection probability is swept adaptively, until saturation point is bracketed */
+	if (config.getKeyValue("CONFIG", "SaturationSearch", value) == 0 && atoi(value.c_str()) > 0) {
+		if (g_sweep_key != NULL) {
+			cerr << "ERROR: SaturationSearch and SweepKey can not be employed together" << endl;
+			exit(-1);
+		}
+		g_saturation_search = true;
+		g_sweep_key = new char[strlen("Probability") + 1];
+		strcpy(g_sweep_key, "Probability");
+		if (config.getKeyValue("CONFIG", "SaturationTolerance", value) == 0)
+			g_saturation_tolerance = atof(value.c_str());
+		assert(g_saturation_tolerance > 0);
+		if (config.getKeyValue("CONFIG", "SaturationRatio", value) == 0) g_saturation_ratio = atof(value.c_str());
+		assert(g_saturation_ratio > 0 && g_saturation_ratio <= 1);
+		if (config.getKeyValue("CONFIG", "Probability", value) != 0) {
+			value = "Probability=100";
+			config.updateKeyValue("CONFIG", &value[0]);
+		}
+	}
+	/* Replications: same configuration simulated with consecutive seeds, over a network built once */
+	if (config.getKeyValue("CONFIG", "Replications", value) == 0 && atoi(value.c_str()) > 1) {
+		if (g_sweep_key != NULL) {
+			cerr << "ERROR: Replications can not be employed along with SweepKey or SaturationSearch" << endl;
+			exit(-1);
+		}
+		g_replications = atoi(value.c_str());
+		g_sweep_key = new char[strlen("Seed") + 1];
+		strcpy(g_sweep_key, "Seed");
+		assert(config.getKeyValue("CONFIG", "Seed", value) == 0);
+		for (i = 0; i < g_replications; i++) {
+			ostringstream seed;
+			seed << atoll(value.c_str()) + i;
+			g_sweep_values.push_back(seed.str());
+		}
+	}
+	/* Batch: every combination of the values of several parameters (axes) is simulated as a separate run */
+	if (config.getKeyValue("CONFIG", "BatchAxes", value) == 0) {
+		/* Command line values are not split into lists */
+		istringstream axes(value);
+		while (getline(axes, value, ','))
+			g_batch_axes.push_back(value);
+	} else if (config.getListValues("CONFIG", "BatchAxes", list_values) == 0) {
+		g_batch_axes = list_values;
+	}
+	for (i = 0; i < (int) g_batch_axes.size(); i++) {
+		vector<string> axis_values;
+		/* Values given in the command line take precedence over those listed in the config file */
+		if (config.getKeyValue("CONFIG", g_batch_axes[i].c_str(), value) == 0) {
+			istringstream values(value);
+			while (getline(values, value, ','))
+				axis_values.push_back(value);
+		} else {
+			config.getListValues("CONFIG", g_batch_axes[i].c_str(), axis_values);
+		}
+		if (axis_values.empty()) {
+			cerr << "ERROR: batch axis " << g_batch_axes[i] << " has no values" << endl;
+			exit(-1);
+		}
+		g_batch_values.push_back(axis_values);
+		/* Rest of the configuration is read with the first value of every axis */
+		value = g_batch_axes[i] + "=" + axis_values[0];
+		config.updateKeyValue("CONFIG", &value[0]);
+	}
+	if (!g_batch_axes.empty()) {
+		if (g_sweep_key != NULL) {
+			cerr << "ERROR: BatchAxes can not be employed along with SweepKey, SaturationSearch or Replications" << endl;
+			exit(-1);
+		}
+		if (config.getKeyValue("CONFIG", "BatchMemoryLimit", value) == 0) g_batch_memory_limit = atoll(value.c_str());
+		assert(g_batch_memory_limit >= 0);
+	}
+	/* Branching: a single warmup, after which every variant is simulated in its own process */
+	if (config.getListValues("CONFIG", "BranchVariants", list_values) == 0) {
+		g_branch_variants = list_values;
+	} else if (config.getKeyValue("CONFIG", "BranchVariants", value) == 0) {
+		/* Command line values are not split into lists */
+		istringstream values(value);
+		while (getline(values, value, ','))
+			g_branch_variants.push_back(value);
+	}
+	if ((g_sweep_key != NULL || !g_branch_variants.empty() || !g_batch_axes.empty())
+			&& config.getKeyValue("CONFIG", "SweepJobs", value) == 0) {
+		g_sweep_jobs = atoi(value.c_str());
+		assert(g_sweep_jobs >= 0);
+	}
+
+	/* Keep a copy of the parameters in use, to be stored along with results */
+	config.getKeyEntries("CONFIG", g_config_parameters);
+	/* Sweep settings are not part of the parameters of any single run */
+	g_config_parameters.erase("SweepKey");
+	g_config_parameters.erase("SweepValues");
+	g_config_parameters.erase("SweepRange");
+	g_config_parameters.erase("SweepJobs");
+	g_config_parameters.erase("SaturationSearch");
+	g_config_parameters.erase("SaturationTolerance");
+	g_config_parameters.erase("SaturationRatio");
+	g_config_parameters.erase("Replications");
+	g_config_parameters.erase("BranchVariants");
+	g_config_parameters.erase("BatchAxes");
+	g_config_parameters.erase("BatchMemoryLimit");
+
 	/* Initialize auxiliar parameters */
         //TODO Implement an indeterminate number of phases in this kind of traffic
 	g_phase_traffic_adv_dist = new int[3];
@@ -210,8 +419,46 @@ void readConfiguration(int argc, char *argv[]) {
 		g_warmup_cycles = atoi(value.c_str());
 	else
 		g_warmup_cycles = g_max_cycles;
+	/* Steady-state detection may end warmup earlier; WarmupCycles is then an upper bound */
+	if (config.getKeyValue("CONFIG", "SteadyStateWindow", value) == 0) g_steady_state_window = atoll(value.c_str());
+	assert(g_steady_state_window >= 0);
+	/* Confidence intervals may end simulation earlier; MaxCycles is then an upper bound */
+	if (config.getKeyValue("CONFIG", "CITarget", value) == 0) g_ci_target = atof(value.c_str());
+	assert(g_ci_target >= 0);
+	if (g_ci_target > 0) {
+		vector<string> metrics;
+		if (config.getKeyValue("CONFIG", "CIBatchCycles", value) == 0) g_ci_batch_cycles = atoll(value.c_str());
+		assert(g_ci_batch_cycles > 0);
+		if (config.getListValues("CONFIG", "CIMetrics", metrics) != 0
+				&& config.getKeyValue("CONFIG", "CIMetrics", value) == 0) {
+			/* Command line values are not split into lists */
+			istringstream values(value);
+			while (getline(values, value, ','))
+				metrics.push_back(value);
+		}
+		for (i = 0; i < (int) metrics.size(); i++) {
+			CIMetric metric;
+			readCIMetric(metrics[i].c_str(), &metric);
+			g_ci_metrics.push_back(metric);
+		}
+		if (g_ci_metrics.empty()) {
+			g_ci_metrics.push_back(FLIT_LATENCY);
+			g_ci_metrics.push_back(PACKET_LATENCY);
+			g_ci_metrics.push_back(ACCEPTED_LOAD);
+		}
+	}
 
 	if (config.getKeyValue("CONFIG", "PrintCycles", value) == 0) g_print_cycles = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "PrintProgress", value) == 0) g_print_progress = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "PrintInterval", value) == 0) g_print_interval = atof(value.c_str());
+	if (config.getKeyValue("CONFIG", "SampleCycles", value) == 0) {
+		g_sample_cycles = atoll(value.c_str());
+		assert(g_sample_cycles >= 0);
+	}
+	if (config.getKeyValue("CONFIG", "SampleBufferLength", value) == 0) {
+		g_sample_buffer_length = atoi(value.c_str());
+		assert(g_sample_buffer_length > 0);
+	}
 
 	assert(config.getKeyValue("CONFIG", "ArbiterIterations", value) == 0);
 	g_allocator_iterations = atoi(value.c_str());
@@ -230,6 +477,8 @@ void readConfiguration(int argc, char *argv[]) {
 
 	assert(config.getKeyValue("CONFIG", "Seed", value) == 0);
 	g_seed = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "CommonRandomNumbers", value) == 0)
+		g_common_random_numbers = atoi(value.c_str());
 
 	assert(config.getKeyValue("CONFIG", "OutputFileName", value) == 0);
 	g_output_file_name = new char[value.length() + 1];
@@ -281,6 +530,9 @@ void readConfiguration(int argc, char *argv[]) {
 
 	assert(config.getKeyValue("CONFIG", "PalmTreeConfiguration", value) == 0);
 	g_palm_tree_configuration = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "CompactTables", value) == 0) g_compact_tables = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "MemoryBudget", value) == 0) g_memory_budget = atoll(value.c_str());
+	assert(g_memory_budget >= 0);
 
 	if (config.getKeyValue("CONFIG", "InputArbiter", value) == 0) {
 		readArbiterType(value.c_str(), &g_input_arbiter_type);
@@ -574,7 +826,7 @@ void readConfiguration(int argc, char *argv[]) {
 				g_graph_tree_level.push_back(0);
 				/* Choose a random node of the current instance as root */
 				g_graph_root_node.push_back(
-						g_trace_2_gen_map[0][rand() / (int) (((unsigned) RAND_MAX + 1) / (g_trace_nodes[0]))][i]);
+						traceNodeGenerator(0, rand() / (int) (((unsigned) RAND_MAX + 1) / (g_trace_nodes[0])), i));
 				/* Upper bound of the p2p queries */
 				g_graph_queries_remain.push_back(
 						pow(2, g_graph_scale + 1) * g_graph_edgefactor * ((g_trace_nodes[0] - 1.0) / g_trace_nodes[0]));
@@ -678,6 +930,15 @@ void readConfiguration(int argc, char *argv[]) {
 				g_cutmpi = atol(value.c_str());
 			}
 
+			if (config.getKeyValue("CONFIG", "collective_algorithm", value) == 0) {
+				readCollectiveAlgorithm(value.c_str(), &g_collective_algorithm);
+			}
+
+			if (config.getKeyValue("CONFIG", "TraceWindow", value) == 0) {
+				g_trace_window = atol(value.c_str());
+				assert(g_trace_window == 0 || g_trace_window > 1);
+			}
+
 			if (config.getKeyValue("CONFIG", "phit_size", value) == 0) {
 				g_phit_size = atol(value.c_str());
 			}
@@ -1221,6 +1482,18 @@ void readConfiguration(int argc, char *argv[]) {
 	/* Optional parameters (can be avoided) */
 
 	if (config.getKeyValue("CONFIG", "PrintHists", value) == 0) g_print_hists = atoi(value.c_str());
+	if (config.getKeyValue("CONFIG", "HistogramPrecision", value) == 0) {
+		g_histogram_precision = atoi(value.c_str());
+		assert(g_histogram_precision >= 1 && g_histogram_precision <= 24);
+	}
+	if (config.getKeyValue("CONFIG", "ResultsFormat", value) == 0)
+		readResultsFormat(value.c_str(), &g_results_format);
+	if (g_results_format != TEXT) {
+		/* Results records are appended, so that several runs can share the same file */
+		if (config.getKeyValue("CONFIG", "ResultsFile", value) != 0) value = string(g_output_file_name) + ".jsonl";
+		g_results_file_name = new char[value.length() + 1];
+		strcpy(g_results_file_name, value.c_str());
+	}
 
 	/* If transient statistics are requested (or transient traffic is used) check their length */
 	if (config.getKeyValue("CONFIG", "trackTempStats", value) == 0) g_transient_stats = atoi(value.c_str());
@@ -1257,6 +1530,45 @@ void readConfiguration(int argc, char *argv[]) {
 		if (config.getKeyValue("CONFIG", "VerboseCycles", value) == 0) g_verbose_cycles = atoi(value.c_str());
 	}
 
+	/* Packet tracing: optionally restricted to some packets, source groups and/or switches */
+	if (config.getKeyValue("CONFIG", "PacketTrace", value) == 0) g_packet_trace = atoi(value.c_str());
+	if (g_packet_trace) {
+		if (config.getKeyValue("CONFIG", "PacketTraceBufferLength", value) == 0)
+			g_packet_trace_buffer_length = atoi(value.c_str());
+		assert(g_packet_trace_buffer_length > 0);
+		if (config.getListValues("CONFIG", "PacketTracePackets", list_values) == 0)
+			for (i = 0; i < list_values.size(); i++)
+				g_packet_trace_packets.insert(atoll(list_values[i].c_str()));
+		if (config.getListValues("CONFIG", "PacketTraceGroups", list_values) == 0)
+			for (i = 0; i < list_values.size(); i++)
+				g_packet_trace_groups.insert(atoi(list_values[i].c_str()));
+		if (config.getListValues("CONFIG", "PacketTraceSwitches", list_values) == 0)
+			for (i = 0; i < list_values.size(); i++)
+				g_packet_trace_switches.insert(atoi(list_values[i].c_str()));
+	}
+
+	if (config.getKeyValue("CONFIG", "Profile", value) == 0) g_profile = atoi(value.c_str());
+
+	/* Checkpoints: state after warmup (and periodically afterwards) may be stored, and runs restored from it */
+	if (config.getKeyValue("CONFIG", "CheckpointSave", value) == 0) {
+		g_checkpoint_save_file = new char[value.length() + 1];
+		strcpy(g_checkpoint_save_file, value.c_str());
+		if (config.getKeyValue("CONFIG", "CheckpointInterval", value) == 0) g_checkpoint_interval = atoll(value.c_str());
+		assert(g_checkpoint_interval >= 0);
+	}
+	if (config.getKeyValue("CONFIG", "CheckpointRestore", value) == 0) {
+		g_checkpoint_restore_file = new char[value.length() + 1];
+		strcpy(g_checkpoint_restore_file, value.c_str());
+	}
+	if (g_checkpoint_save_file != NULL || g_checkpoint_restore_file != NULL) checkCheckpointSupport();
+	/* All runs of a sweep would store their checkpoints into the same file */
+	if ((g_sweep_key != NULL || !g_batch_axes.empty()) && g_checkpoint_save_file != NULL) {
+		cerr << "ERROR: checkpoints can not be stored within a sweep" << endl;
+		exit(-1);
+	}
+	if (!g_branch_variants.empty()) checkBranchVariants();
+
+
 	/* QCN implementation restrictions */
 	if (g_congestion_management == QCNSW) {
 		assert(g_buffer_type == SEPARATED);
@@ -1279,6 +1591,8 @@ void createNetwork() {
 
 	g_ports = g_p_computing_nodes_per_router + g_a_routers_per_group - 1 + g_h_global_ports_per_router;
 	g_global_links_per_group = g_a_routers_per_group * g_h_global_ports_per_router;
+	g_local_router_links_offset = g_p_computing_nodes_per_router;
+	g_global_router_links_offset = g_local_router_links_offset + g_a_routers_per_group - 1;
 
 	if (g_deadlock_avoidance == EMBEDDED_TREE) {
 		g_tree_root_node = rand() % g_number_switches; /* We used this node to route packets to the root switch */
@@ -1296,21 +1610,14 @@ void createNetwork() {
 		g_localEmbeddedRingSwitchesCount = g_number_switches; /* Every switch in the group dedicates 1 or 2 local links to the embedded ring */
 	}
 
-	g_latency_histogram_no_global_misroute.insert(g_latency_histogram_no_global_misroute.begin(),
-			g_latency_histogram_maxLat, 0);
-	g_latency_histogram_global_misroute_at_injection.insert(g_latency_histogram_global_misroute_at_injection.begin(),
-			g_latency_histogram_maxLat, 0);
-	g_latency_histogram_other_global_misroute.insert(g_latency_histogram_other_global_misroute.begin(),
-			g_latency_histogram_maxLat, 0);
-
-	g_hops_histogram = new long long[g_hops_histogram_maxHops];
-
-	for (i = 0; i < g_hops_histogram_maxHops; i++) {
-		g_hops_histogram[i] = 0;
-	}
+	/* Project memory footprint before building the network, to abort early if it does not fit */
+	planMemory();
 
-	g_local_router_links_offset = g_p_computing_nodes_per_router;
-	g_global_router_links_offset = g_local_router_links_offset + g_a_routers_per_group - 1;
+	g_latency_histogram_no_global_misroute = new logHistogram(g_histogram_precision, g_histogram_max_value);
+	g_latency_histogram_global_misroute_at_injection = new logHistogram(g_histogram_precision, g_histogram_max_value);
+	g_latency_histogram_other_global_misroute = new logHistogram(g_histogram_precision, g_histogram_max_value);
+	g_injection_latency_histogram = new logHistogram(g_histogram_precision, g_histogram_max_value);
+	g_hops_histogram = new logHistogram(g_histogram_precision, g_histogram_max_value);
 
 	g_group0_numFlits = new long long**[g_a_routers_per_group];
 	g_group0_totalLatency = new long double[g_a_routers_per_group];
@@ -1374,9 +1681,6 @@ void createNetwork() {
 			break;
 	}
 
-	cout << "switchModule size: " << sizeof(switchModule) << endl;
-	cout << "generatorModule size: " << sizeof(generatorModule) << endl;
-
 	if (g_vc_usage == FLEXIBLE || g_vc_usage == TBFLEX) g_channels = g_local_link_channels + g_global_link_channels;
 	// Fill a list with all generators, in use only by RANDOMPERMUTATION traffics to select the destinations for generators
 	if (g_traffic == RANDOMPERMUTATION || g_traffic == RANDOMPERMUTATION_RCTV)
@@ -1455,6 +1759,7 @@ void createNetwork() {
 		g_switches_list[i]->routing->initialize(g_switches_list);
 		g_switches_list[i]->resetCredits();
 	}
+	if (g_compact_tables) reportSharedTables();
 
 	//transient stats variables
 	//initialize records
@@ -1486,18 +1791,70 @@ void createNetwork() {
 			/* Initiate trace_ended map */
 			g_trace_ended.push_back(vector<bool>(g_trace_instances[i], false));
 			assert(g_trace_ended[i].size() == g_trace_instances[i]); // Sanity check
-			/* Initiate event_deadlock and trace_end_cycle vectors: one entry per every trace instance */
-			g_event_deadlock.push_back(vector<long>(g_trace_instances[i], 0));
-			assert(g_event_deadlock[i].size() == g_trace_instances[i]); // Sanity check
+			/* Initiate event_progress, trace_end_cycle and active_nodes vectors: one entry per every trace instance */
+			g_event_progress.push_back(vector<long long>(g_trace_instances[i], 0));
+			assert(g_event_progress[i].size() == g_trace_instances[i]); // Sanity check
 			g_trace_end_cycle.push_back(vector<long>(g_trace_instances[i], -1));
 			assert(g_trace_end_cycle[i].size() == g_trace_instances[i]); // Sanity check
+			g_trace_active_nodes.push_back(vector<int>(g_trace_instances[i], 0));
 		}
 	}
 }
 
+/*
+ * Aborts the simulation if any trace instance has not progressed (nor been
+ * computing) for too long; otherwise, sets the earliest cycle a deadlock
+ * could be detected at, so that instances are not checked every cycle.
+ */
+void checkEventDeadlock() {
+	const long long deadlock_cycles = 2000000;
+	long long oldest = LLONG_MAX;
+	int i, j, k, gen;
+
+	for (i = 0; i < g_event_progress.size(); i++) {
+		for (j = 0; j < g_event_progress[i].size(); j++) {
+			if (g_cycle - g_event_progress[i][j] > deadlock_cycles) {
+				cerr << "EVENT DEADLOCK detected at cycle " << g_cycle << " in trace " << i << ", instance " << j
+						<< endl;
+				for (k = 0; k < g_trace_nodes[i]; k++) {
+					gen = traceNodeGenerator(i, k, j);
+					cerr << "Node " << k << " -> gen " << gen << endl;
+					g_generators_list[gen]->printHeadEvent();
+				}
+				for (k = 0; k < g_number_generators; k++) {
+					g_generators_list[k]->printHeadEvent();
+				}
+				cerr << "EVENT DEADLOCK!!" << endl;
+				assert(0);
+			}
+			oldest = min(oldest, g_event_progress[i][j]);
+		}
+	}
+	g_event_deadlock_check = oldest + deadlock_cycles + 1;
+}
+
+/*
+ * Determines whether a temporary stats print is allowed. Prints can be
+ * disabled altogether, or rate-limited to one every g_print_interval
+ * seconds of wall-clock time (useful for long runs logged to a file).
+ */
+bool isProgressPrintDue() {
+	static chrono::steady_clock::time_point last_print;
+	static bool printed = false;
+	chrono::steady_clock::time_point now;
+
+	if (!g_print_progress) return false;
+	if (g_print_interval <= 0) return true;
+	now = chrono::steady_clock::now();
+	if (printed && chrono::duration<float>(now - last_print).count() < g_print_interval) return false;
+	last_print = now;
+	printed = true;
+	return true;
+}
+
 void action() {
 	int i, j, print_cycle, totalSwitchSpace, totalSwitchFreeSpace, flitWaitingCount;
-	bool trace_ended;
+	long long prof_start, restored_cycle = -1;
 
 	totalSwitchSpace = 0;
 	totalSwitchFreeSpace = 0;
@@ -1506,9 +1863,26 @@ void action() {
 	g_warmup_packet_latency = 0;
 	g_warmup_injection_latency = 0;
 
+	/* Batch means span the whole measurement, so they are part of the checkpoint */
+	if (g_ci_target > 0) {
+		if (g_traffic != TRACE && g_traffic != GRAPH500)
+			g_batch_means = new batchMeans(g_ci_batch_cycles);
+		else
+			cerr << "WARNING: CITarget is ignored with trace-driven traffic" << endl;
+	}
+
+	/* A restored run resumes from the checkpoint cycle, skipping warmup */
+	g_cycle = 0;
+	if (g_checkpoint_restore_file != NULL) {
+		readCheckpoint(g_checkpoint_restore_file);
+		restored_cycle = g_cycle;
+	}
+
 	/* WARMUP execution [only for synthetic traffic] */
 	if (g_traffic != TRACE && g_traffic != GRAPH500) {
-		for (g_cycle = 0; g_cycle < g_warmup_cycles; g_cycle++) {
+		if (g_steady_state_window > 0 && g_cycle < g_warmup_cycles)
+			g_steady_state_detector = new steadyStateDetector(g_steady_state_window);
+		for (; g_cycle < g_warmup_cycles; g_cycle++) {
 			print_cycle = g_cycle % 100;
 			if (g_switch_type == BASE_SW) g_internal_cycle = g_cycle;
 			for (i = 0; i < g_number_switches; i++) {
@@ -1516,94 +1890,117 @@ void action() {
 				assert(g_switches_list[i]->messagesInQueuesCounter >= 0);
 				if (g_switches_list[i]->messagesInQueuesCounter >= 1) g_switches_list[i]->action();
 			}
+			prof_start = profilerStart();
 			for (i = 0; i < g_number_generators; i++) {
 				g_generators_list[i]->action();
 			}
+			profilerStop(PROF_GENERATORS, prof_start);
+			if (g_metrics_sampler != NULL && g_metrics_sampler->isSampleDue()) g_metrics_sampler->sample();
+			/* Once the network has converged, warmup ends with current cycle */
+			if (g_steady_state_detector != NULL && g_steady_state_detector->isSampleDue()
+					&& g_steady_state_detector->sample()) g_warmup_cycles = g_cycle + 1;
 			if (print_cycle == 0) {
-				cout.precision(5);
-				cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tMessages sent:" << setfill(' ') << setw(12)
-						<< g_tx_flit_counter << "\tMessages received:" << setfill(' ') << setw(12) << g_rx_flit_counter
-						<< "\tApplied load: " << setfill(' ')
-						<< (float) (1.0 * g_tx_flit_counter - g_tx_flit_counter_printC) * g_flit_size
-								/ (1.0 * g_number_generators * 100) << "\tAccepted load: " << setfill(' ')
-						<< (float) (1.0 * g_rx_flit_counter - g_rx_flit_counter_printC) * g_flit_size
-								/ (1.0 * g_number_generators * 100) << endl;
+				if (isProgressPrintDue()) {
+					cout.precision(5);
+					cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tMessages sent:" << setfill(' ')
+							<< setw(12) << g_tx_flit_counter << "\tMessages received:" << setfill(' ') << setw(12)
+							<< g_rx_flit_counter << "\tApplied load: " << setfill(' ')
+							<< (float) (1.0 * g_tx_flit_counter - g_tx_flit_counter_printC) * g_flit_size
+									/ (1.0 * g_number_generators * 100) << "\tAccepted load: " << setfill(' ')
+							<< (float) (1.0 * g_rx_flit_counter - g_rx_flit_counter_printC) * g_flit_size
+									/ (1.0 * g_number_generators * 100) << endl;
+					if (g_congestion_management == QCNSW)
+						cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tCNMs sent    :" << setfill(' ')
+								<< setw(12) << g_tx_cnmFlit_counter << "\tCNMs received    :" << setfill(' ')
+								<< setw(12) << g_rx_cnmFlit_counter << endl;
+				}
 				g_tx_flit_counter_printC = g_tx_flit_counter;
 				g_rx_flit_counter_printC = g_rx_flit_counter;
-				if (g_congestion_management == QCNSW)
-					cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tCNMs sent    :" << setfill(' ')
-							<< setw(12) << g_tx_cnmFlit_counter << "\tCNMs received    :" << setfill(' ') << setw(12)
-							<< g_rx_cnmFlit_counter << endl;
-			}
-		}
-	}
-
-	/* Reset hop and contention counters */
-	g_total_hop_counter = 0;
-	g_local_hop_counter = 0;
-	g_global_hop_counter = 0;
-	g_local_ring_hop_counter = 0;
-	g_global_ring_hop_counter = 0;
-	g_local_tree_hop_counter = 0;
-	g_global_tree_hop_counter = 0;
-	g_local_contention_counter = 0;
-	g_global_contention_counter = 0;
-	g_local_escape_contention_counter = 0;
-	g_global_escape_contention_counter = 0;
-	for (i = 0; i < g_ports; i++) {
-		g_port_usage_counter[i] = 0;
-		g_port_contention_counter[i] = 0;
-	}
-	for (i = 0; i < (g_a_routers_per_group - 1); i++) {
-		for (int j = 0; j < g_local_link_channels; j++)
-			g_vc_counter[i][j] = 0;
-	}
-	for (i = 0; i < g_h_global_ports_per_router; i++) {
-		for (int j = 0; j < g_global_link_channels; j++)
-			g_vc_counter[i][j] = 0;
+			}
+		}
 	}
 
-	for (i = 0; i < g_number_switches; i++) {
-		totalSwitchSpace = g_switches_list[i]->getTotalCapacity();
-		totalSwitchFreeSpace = g_switches_list[i]->getTotalFreeSpace();
-		flitWaitingCount += totalSwitchSpace - totalSwitchFreeSpace;
-		g_switches_list[i]->resetQueueOccupancy();
-	}
-	g_tx_warmup_flit_counter = g_tx_flit_counter;
-	g_tx_warmup_cnmFlit_counter = g_tx_cnmFlit_counter;
-	g_rx_warmup_flit_counter = g_rx_flit_counter;
-	g_rx_warmup_cnmFlit_counter = g_rx_cnmFlit_counter;
-        for (int acorStatus = None; acorStatus <= RRGLSw; acorStatus++)
-            g_rx_warmup_acorState_counter[acorStatus] = g_rx_acorState_counter[acorStatus];
-	g_tx_warmup_packet_counter = g_tx_packet_counter;
-	g_rx_warmup_packet_counter = g_rx_packet_counter;
-	g_warmup_flit_latency = g_flit_latency;
-	g_warmup_packet_latency = g_packet_latency;
-	g_warmup_injection_latency = g_injection_queue_latency;
-	g_response_warmup_counter = g_response_counter;
-	g_nonminimal_warmup_counter = g_nonminimal_counter;
-	g_nonminimal_warmup_inj = g_nonminimal_inj;
-	g_nonminimal_warmup_src = g_nonminimal_src;
-	g_nonminimal_warmup_int = g_nonminimal_int;
-	cout << "=== Cycle:" << g_cycle << "\tWarmup Flits Sent: " << setw(12) << g_tx_warmup_flit_counter
-			<< "\tWarmup Flits Received: " << setw(12) << g_rx_warmup_flit_counter << "\tApplied Load: "
-			<< (float) (1.0 * g_tx_warmup_flit_counter) * g_flit_size / (1.0 * g_number_generators * g_cycle)
-			<< "\tAccepted Load: "
-			<< (float) (1.0 * g_rx_warmup_flit_counter) * g_flit_size / (1.0 * g_number_generators * g_cycle) << " ==="
-			<< endl;
-	if (g_congestion_management == QCNSW)
-		cout << "=== Cycle:" << g_cycle << "\tWarmup CNMs Sent : " << setw(12) << g_tx_warmup_cnmFlit_counter
-				<< "\tWarmup CNMs Received : " << setw(12) << g_rx_warmup_cnmFlit_counter << " ===" << endl;
+	if (g_checkpoint_save_file != NULL && restored_cycle < 0) writeCheckpoint(g_checkpoint_save_file);
+
+	/* Warmup statistics are part of the checkpoint when restoring past warmup */
+	if (restored_cycle <= g_warmup_cycles) {
+		/* Reset hop and contention counters */
+		g_total_hop_counter = 0;
+		g_local_hop_counter = 0;
+		g_global_hop_counter = 0;
+		g_local_ring_hop_counter = 0;
+		g_global_ring_hop_counter = 0;
+		g_local_tree_hop_counter = 0;
+		g_global_tree_hop_counter = 0;
+		g_local_contention_counter = 0;
+		g_global_contention_counter = 0;
+		g_local_escape_contention_counter = 0;
+		g_global_escape_contention_counter = 0;
+		for (i = 0; i < g_ports; i++) {
+			g_port_usage_counter[i] = 0;
+			g_port_contention_counter[i] = 0;
+		}
+		for (i = 0; i < (g_a_routers_per_group - 1); i++) {
+			for (int j = 0; j < g_local_link_channels; j++)
+				g_vc_counter[i][j] = 0;
+		}
+		for (i = 0; i < g_h_global_ports_per_router; i++) {
+			for (int j = 0; j < g_global_link_channels; j++)
+				g_vc_counter[i][j] = 0;
+		}
 
-	/* Reset petition statistics */
-	g_petitions = 0;
-	g_served_petitions = 0;
-	g_injection_petitions = 0;
-	g_served_injection_petitions = 0;
+		for (i = 0; i < g_number_switches; i++) {
+			totalSwitchSpace = g_switches_list[i]->getTotalCapacity();
+			totalSwitchFreeSpace = g_switches_list[i]->getTotalFreeSpace();
+			flitWaitingCount += totalSwitchSpace - totalSwitchFreeSpace;
+			g_switches_list[i]->resetQueueOccupancy();
+		}
+		g_tx_warmup_flit_counter = g_tx_flit_counter;
+		g_tx_warmup_cnmFlit_counter = g_tx_cnmFlit_counter;
+		g_rx_warmup_flit_counter = g_rx_flit_counter;
+		g_rx_warmup_cnmFlit_counter = g_rx_cnmFlit_counter;
+	        for (int acorStatus = None; acorStatus <= RRGLSw; acorStatus++)
+	            g_rx_warmup_acorState_counter[acorStatus] = g_rx_acorState_counter[acorStatus];
+		g_tx_warmup_packet_counter = g_tx_packet_counter;
+		g_rx_warmup_packet_counter = g_rx_packet_counter;
+		g_warmup_flit_latency = g_flit_latency;
+		g_warmup_packet_latency = g_packet_latency;
+		g_warmup_injection_latency = g_injection_queue_latency;
+		g_response_warmup_counter = g_response_counter;
+		g_nonminimal_warmup_counter = g_nonminimal_counter;
+		g_nonminimal_warmup_inj = g_nonminimal_inj;
+		g_nonminimal_warmup_src = g_nonminimal_src;
+		g_nonminimal_warmup_int = g_nonminimal_int;
+		cout << "=== Cycle:" << g_cycle << "\tWarmup Flits Sent: " << setw(12) << g_tx_warmup_flit_counter
+				<< "\tWarmup Flits Received: " << setw(12) << g_rx_warmup_flit_counter << "\tApplied Load: "
+				<< (float) (1.0 * g_tx_warmup_flit_counter) * g_flit_size / (1.0 * g_number_generators * g_cycle)
+				<< "\tAccepted Load: "
+				<< (float) (1.0 * g_rx_warmup_flit_counter) * g_flit_size / (1.0 * g_number_generators * g_cycle) << " ==="
+				<< endl;
+		if (g_congestion_management == QCNSW)
+			cout << "=== Cycle:" << g_cycle << "\tWarmup CNMs Sent : " << setw(12) << g_tx_warmup_cnmFlit_counter
+					<< "\tWarmup CNMs Received : " << setw(12) << g_rx_warmup_cnmFlit_counter << " ===" << endl;
+
+		/* Reset petition statistics */
+		g_petitions = 0;
+		g_served_petitions = 0;
+		g_injection_petitions = 0;
+		g_served_injection_petitions = 0;
+
+		if (g_batch_means != NULL) g_batch_means->start();
+	}
+
+	/* Every variant resumes from the state reached so far, in its own process */
+	if (!g_branch_variants.empty()) runBranches();
 
 	/* Simulation AFTER warmup */
 	if (g_traffic != TRACE && g_traffic != GRAPH500) {
 		for (; g_cycle < (g_max_cycles + g_warmup_cycles); g_cycle++) {
+			if (g_checkpoint_interval > 0 && g_cycle > g_warmup_cycles && g_cycle != restored_cycle
+					&& (g_cycle - g_warmup_cycles) % g_checkpoint_interval == 0)
+				writeCheckpoint(g_checkpoint_save_file);
+			/* Measurement ends as soon as the confidence intervals are narrow enough */
+			if (g_batch_means != NULL && g_batch_means->isBatchDue() && g_batch_means->closeBatch()) break;
 			print_cycle = g_cycle % 100;
 			if (g_switch_type == BASE_SW) g_internal_cycle = g_cycle;
 			for (i = 0; i < g_number_switches; i++) {
@@ -1613,23 +2010,29 @@ void action() {
 					g_switches_list[i]->action();
 				}
 			}
+			prof_start = profilerStart();
 			for (i = 0; i < g_number_generators; i++) {
 				if (!g_generators_list[i]->switchM->escapeNetworkCongested) g_generators_list[i]->action();
 			}
+			profilerStop(PROF_GENERATORS, prof_start);
+			if (g_metrics_sampler != NULL && g_metrics_sampler->isSampleDue()) g_metrics_sampler->sample();
 			if (print_cycle == 0) {
-				cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tMessages sent:" << setfill(' ') << setw(12)
-						<< g_tx_flit_counter << "\tMessages received:" << setfill(' ') << setw(12) << g_rx_flit_counter
-						<< "\tApplied load: " << setfill(' ') << setw(4)
-						<< (float) (1.0 * g_tx_flit_counter - g_tx_flit_counter_printC) * g_flit_size
-								/ (1.0 * g_number_generators * 100) << "\tAccepted load: " << setfill(' ') << setw(4)
-						<< (float) (1.0 * g_rx_flit_counter - g_rx_flit_counter_printC) * g_flit_size
-								/ (1.0 * g_number_generators * 100) << endl;
+				if (isProgressPrintDue()) {
+					cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tMessages sent:" << setfill(' ')
+							<< setw(12) << g_tx_flit_counter << "\tMessages received:" << setfill(' ') << setw(12)
+							<< g_rx_flit_counter << "\tApplied load: " << setfill(' ') << setw(4)
+							<< (float) (1.0 * g_tx_flit_counter - g_tx_flit_counter_printC) * g_flit_size
+									/ (1.0 * g_number_generators * 100) << "\tAccepted load: " << setfill(' ')
+							<< setw(4)
+							<< (float) (1.0 * g_rx_flit_counter - g_rx_flit_counter_printC) * g_flit_size
+									/ (1.0 * g_number_generators * 100) << endl;
+					if (g_congestion_management == QCNSW)
+						cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tCNMs sent    :" << setfill(' ')
+								<< setw(12) << g_tx_cnmFlit_counter << "\tCNMs received    :" << setfill(' ')
+								<< setw(12) << g_rx_cnmFlit_counter << endl;
+				}
 				g_tx_flit_counter_printC = g_tx_flit_counter;
 				g_rx_flit_counter_printC = g_rx_flit_counter;
-				if (g_congestion_management == QCNSW)
-					cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tCNMs sent    :" << setfill(' ')
-							<< setw(12) << g_tx_cnmFlit_counter << "\tCNMs received    :" << setfill(' ') << setw(12)
-							<< g_rx_cnmFlit_counter << endl;
 			}
 
 			/* BURST and ALL2ALL patterns end when all messages have been received */
@@ -1648,10 +2051,13 @@ void action() {
 				if (g_switches_list[i]->messagesInQueuesCounter >= 1) g_switches_list[i]->action();
 			}
 			// Compute nodes action
+			prof_start = profilerStart();
 			for (i = 0; i < g_number_generators; i++)
 				g_generators_list[i]->action();
+			profilerStop(PROF_GENERATORS, prof_start);
+			if (g_metrics_sampler != NULL && g_metrics_sampler->isSampleDue()) g_metrics_sampler->sample();
 			// Print information
-			if (g_cycle % g_print_cycles == 0)
+			if (g_cycle % g_print_cycles == 0 && isProgressPrintDue())
 				cout << "cycle:" << setfill(' ') << setw(8) << g_cycle << "\tMessages sent:" << setfill(' ') << setw(12)
 						<< g_tx_flit_counter << "\tMessages received:" << setfill(' ') << setw(12) << g_rx_flit_counter
 						<< endl;
@@ -1663,7 +2069,7 @@ void action() {
 				graph_all_level_end = true;
 				for (j = 0; j < g_trace_nodes[0] && graph_all_level_end; j++)
 					graph_all_level_end =
-							((graph500Generator *) g_generators_list[g_trace_2_gen_map[0][j][i]])->getState()
+							((graph500Generator *) g_generators_list[traceNodeGenerator(0, j, i)])->getState()
 									== GraphCNState::LEVELEND;
 				// Evaluate end simulation or increase level
 				if (!graph_all_level_end)
@@ -1677,7 +2083,7 @@ void action() {
 															* ((g_trace_nodes[0] - 1.0) / g_trace_nodes[0]))))) {
 						g_graph_tree_level[i]++;
 						for (j = 0; j < g_trace_nodes[0]; j++)
-							((graph500Generator *) g_generators_list[g_trace_2_gen_map[0][j][i]])->setState(
+							((graph500Generator *) g_generators_list[traceNodeGenerator(0, j, i)])->setState(
 									GraphCNState::LEVELSTART);
 						graph_model_ended = false;
 					}
@@ -1687,70 +2093,33 @@ void action() {
 	} else { //  TRACE TRAFFIC
 		g_warmup_cycles = 0;
 		bool go_on = true;
-		int gen;
-		long l, min_length = LONG_MAX;
-		event e;
+		int total_instances = 0;
+		long long wake;
+		vector<pair<int, int> > drained;
+		for (i = 0; i < g_num_traces; i++)
+			total_instances += g_trace_instances[i];
 		for (g_cycle = 0; true; g_cycle++) {
 			bool normal = true;
 			if (g_switch_type == BASE_SW) g_internal_cycle = g_cycle;
-			if (g_tx_flit_counter == g_rx_flit_counter && go_on) {
-				for (gen = 0; gen < g_number_generators; gen++) {
-					l = g_generators_list[gen]->numSkipCycles();
-					if (l < 0) {
-						continue;
-					} else if (l < min_length) {
-						min_length = l;
-						if (min_length == 0) break;
-						/* Determine which trace instance is generator assigned to. */
-						TraceNodeId trace_node = g_gen_2_trace_map[gen];
-						for (j = 0; j < g_trace_instances[trace_node.trace_id]; j++) {
-							if (g_trace_2_gen_map[trace_node.trace_id][trace_node.trace_node][j] == gen) break;
-						}
-						assert(j < g_trace_instances[trace_node.trace_id]);
-						g_event_deadlock[trace_node.trace_id][j] = 0;
-						assert(g_trace_end_cycle[0].size() == g_trace_instances[0]);
-					}
-				}
-				if (min_length > 1 && min_length != LONG_MAX) {
+			/* With the network drained and every generator sleeping, jump
+			 * straight to the cycle before the earliest wake-up */
+			if (g_tx_flit_counter == g_rx_flit_counter && go_on && g_trace_scheduler->isIdle()) {
+				wake = g_trace_scheduler->nextWakeCycle();
+				if (wake != LLONG_MAX) {
 					normal = false;
-					cout << "cycle:" << g_cycle << " skipping " << min_length << " cycles" << endl;
-					min_length--;
-					g_cycle += min_length - 1;
-					for (gen = 0; gen < g_number_generators; gen++) {
-						g_generators_list[gen]->consumeCycles(min_length);
-					}
+					if (isProgressPrintDue())
+						cout << "cycle:" << g_cycle << " skipping " << wake - g_cycle << " cycles" << endl;
+					g_cycle = wake - 1;
 				}
 			}
 
 			if (normal) {
 				print_cycle = g_cycle % 5000;
-				for (i = 0; i < g_event_deadlock.size(); i++) {
-					for (j = 0; j < g_event_deadlock[i].size(); j++) {
-						if (g_event_deadlock[i][j] > 2000000) {
-							cerr << "EVENT DEADLOCK detected at cycle " << g_cycle << " in trace " << i << ", instance "
-									<< j << endl;
-							for (int k = 0; k < g_trace_nodes[i]; k++) {
-								gen = g_trace_2_gen_map[i][k][j];
-								cerr << "Node " << k << " -> gen " << gen << endl;
-								g_generators_list[gen]->printHeadEvent();
-							}
-							for (int k = 0; k < g_number_generators; k++) {
-								g_generators_list[k]->printHeadEvent();
-							}
-							cerr << "EVENT DEADLOCK!!" << endl;
-							assert(0);
-						}
-					}
-				}
+				if (g_cycle >= g_event_deadlock_check) checkEventDeadlock();
 
 				if (go_on == false) {
 					break;
 				}
-				for (i = 0; i < g_event_deadlock.size(); i++) {
-					for (j = 0; j < g_event_deadlock[i].size(); j++) {
-						g_event_deadlock[i][j]++;
-					}
-				}
 				for (i = 0; i < g_number_switches; i++) {
 
 					assert(g_switches_list[i]->messagesInQueuesCounter >= 0);
@@ -1765,44 +2134,34 @@ void action() {
 						}
 					}
 				}
-				for (i = 0; i < g_number_generators; i++) {
-					g_generators_list[i]->action();
-				}
-
-				/* Determine if trace instance has ended, checking every generator
-				 * associated with it. If trace has finished, update end status
-				 * and reload trace. If all traces have finished, stop simulation. */
-				go_on = false;
-				for (i = 0; i < g_num_traces; i++) {
-					for (j = 0; j < g_trace_instances[i]; j++) {
-						trace_ended = true;
-						for (int k = 0; k < g_trace_nodes[i]; k++) {
-							assert(g_trace_2_gen_map[i][k][j] < g_number_generators); /* Sanity check: number of trace nodes has to be below number of available generators */
-							if (!g_generators_list[g_trace_2_gen_map[i][k][j]]->isGenerationEnded()) {
-								trace_ended = false;
-								break;
-							}
-						}
-						if (trace_ended) {
-							if (!g_trace_ended[i][j]) g_trace_end_cycle[i][j] = g_cycle; // Only track first time every trace instance ends
-							g_trace_ended[i][j] = trace_ended; // Update trace instance status
-							cout << "Trace id " << i << ", instance " << j << " has ended on cycle " << g_cycle << endl;
-							vector<int> aux_vector(1, j); // Trace instance has to be introduced as a vector
-							read_trace(i, aux_vector); // Refill trace event queue
-						}
-					}
-				}
-				trace_ended = true;
-				for (i = 0; i < g_num_traces; i++) {
-					assert(g_trace_ended[i].size() == g_trace_instances[i]); // Sanity check
-					for (j = 0; j < g_trace_instances[i]; j++) {
-						trace_ended &= g_trace_ended[i][j];
+				prof_start = profilerStart();
+				g_trace_scheduler->runGenerators();
+				profilerStop(PROF_GENERATORS, prof_start);
+
+				/* Trace instances whose generators have all drained their event
+				 * queues (as notified by the generators) have ended: update end
+				 * status and reload trace. If all traces have finished, stop simulation. */
+				drained.swap(g_trace_drained);
+				sort(drained.begin(), drained.end());
+				for (vector<pair<int, int> >::iterator it = drained.begin(); it != drained.end(); ++it) {
+					i = it->first;
+					j = it->second;
+					assert(g_trace_active_nodes[i][j] == 0);
+					if (!g_trace_ended[i][j]) {
+						g_trace_end_cycle[i][j] = g_cycle; // Only track first time every trace instance ends
+						g_trace_instances_ended++;
 					}
+					g_trace_ended[i][j] = true; // Update trace instance status
+					cout << "Trace id " << i << ", instance " << j << " has ended on cycle " << g_cycle << endl;
+					vector<int> aux_vector(1, j); // Trace instance has to be introduced as a vector
+					read_trace(i, aux_vector); // Refill trace event queue
 				}
+				drained.clear();
 				/* All trace instances have finished once or more times: simulation must be ended at this point */
-				go_on = trace_ended ? false : true;
+				go_on = (g_trace_instances_ended < total_instances);
 
-				if (print_cycle == 0) {
+				if (g_metrics_sampler != NULL && g_metrics_sampler->isSampleDue()) g_metrics_sampler->sample();
+				if (print_cycle == 0 && isProgressPrintDue()) {
 					cout << "cycle:" << g_cycle << "   Messages sent:" << g_tx_flit_counter << "   Messages received:"
 							<< g_rx_flit_counter << endl;
 					if (g_congestion_management == QCNSW)
@@ -1826,11 +2185,13 @@ void writeOutput() {
 	float IQO[g_channels], GRQO[g_channels], LRQO[g_channels], GTQO[g_channels], LTQO[g_channels], GQO[g_channels],
 			LQO[g_channels], OQO = 0;
 	int i;
+	/* Results are written aside and then renamed, so a partial output file is never left behind */
+	string partial_file_name = string(g_output_file_name) + ".tmp";
 
 	/* Open output file */
-	g_output_file.open(g_output_file_name, ios::out);
+	g_output_file.open(partial_file_name.c_str(), ios::out);
 	if (!g_output_file) {
-		cerr << "Can't open the output file" << g_output_file_name << endl;
+		cerr << "Can't open the output file" << partial_file_name << endl;
 		exit(-1);
 	}
 
@@ -1870,6 +2231,10 @@ void writeOutput() {
 	g_output_file << "PARAMETERS" << endl;
 	g_output_file << "Total Number Of Cycles: " << g_cycle << endl;
 	g_output_file << "Max Cycles: " << g_max_cycles << endl;
+	if (g_steady_state_detector != NULL) {
+		g_output_file << "Warmup Cycles: " << g_warmup_cycles << endl;
+		g_steady_state_detector->writeOutput(g_output_file);
+	}
 	g_output_file << "H: " << g_h_global_ports_per_router << endl;
 	g_output_file << "P: " << g_p_computing_nodes_per_router << endl;
 	g_output_file << "A: " << g_a_routers_per_group << endl;
@@ -1971,9 +2336,11 @@ void writeOutput() {
 			break;
 	}
 	g_output_file << "Seed: " << g_seed << endl;
+	if (g_common_random_numbers) g_output_file << "Common Random Numbers: enabled" << endl;
 	g_output_file << "Palm Tree Configuration: " << g_palm_tree_configuration << endl << endl << endl;
 	g_output_file << "Latency Histogram Max Lat: " << g_latency_histogram_maxLat << endl;
 	g_output_file << "Hops Histogram Max Hops: " << g_hops_histogram_maxHops << endl;
+	g_output_file << "Histogram Precision: " << g_histogram_precision << endl;
 	if (g_local_arbiter_speedup > 0) g_output_file << "Input Speedup: " << g_local_arbiter_speedup << endl;
 	if (g_issue_parallel_reqs) g_output_file << "Parallel Req Issuing: 1" << endl;
 	g_output_file << "CoS Levels: " << g_cos_levels << endl;
@@ -2771,6 +3138,7 @@ void writeOutput() {
 			<< (float) 1.0 * (g_nonminimal_int - g_nonminimal_warmup_int) * g_flit_size
 					/ (1.0 * g_number_generators * (g_cycle - g_warmup_cycles)) << " phits/(node·cycle)" << endl;
 	g_output_file << "Cycles: " << g_cycle << " (warmup: " << g_warmup_cycles << ")" << endl;
+	if (g_batch_means != NULL) g_batch_means->writeOutput(g_output_file);
 	g_output_file << "Total Hops: " << g_total_hop_counter << endl;
 	g_output_file << "Local Hops: " << g_local_hop_counter << endl;
 	g_output_file << "Global Hops: " << g_global_hop_counter << endl;
@@ -2859,14 +3227,23 @@ void writeOutput() {
 			<< g_warmup_injection_latency << ")" << endl;
 	g_output_file << "Base Latency: " << g_base_latency << endl;
 	g_output_file << "Average Total Latency: " << (g_flit_latency - g_warmup_flit_latency) / receivedFlitCount << endl;
-	for (i = 0; i < g_latency_histogram_maxLat; i++) {
-		if (g_latency_histogram_no_global_misroute[i] + g_latency_histogram_global_misroute_at_injection[i]
-				+ g_latency_histogram_other_global_misroute[i] > 0) {
-			g_output_file << "Min Total Latency: " << i << endl;
-			break;
-		}
-	}
+	/* Merge all latency histograms to obtain overall distribution */
+	logHistogram total_latency_histogram(g_histogram_precision, g_histogram_max_value);
+	total_latency_histogram.merge(*g_latency_histogram_no_global_misroute);
+	total_latency_histogram.merge(*g_latency_histogram_global_misroute_at_injection);
+	total_latency_histogram.merge(*g_latency_histogram_other_global_misroute);
+	if (total_latency_histogram.getTotalCount() > 0)
+		g_output_file << "Min Total Latency: " << total_latency_histogram.getMinValue() << endl;
 	g_output_file << "Max Total Latency: " << g_latency_histogram_maxLat - 1 << endl;
+	g_output_file << "Total Latency p50: " << total_latency_histogram.getValueAtPercentile(50) << endl;
+	g_output_file << "Total Latency p99: " << total_latency_histogram.getValueAtPercentile(99) << endl;
+	g_output_file << "Total Latency p99.9: " << total_latency_histogram.getValueAtPercentile(99.9) << endl;
+	g_output_file << "Inj Latency p50: " << g_injection_latency_histogram->getValueAtPercentile(50) << endl;
+	g_output_file << "Inj Latency p99: " << g_injection_latency_histogram->getValueAtPercentile(99) << endl;
+	g_output_file << "Inj Latency p99.9: " << g_injection_latency_histogram->getValueAtPercentile(99.9) << endl;
+	g_output_file << "Hops p50: " << g_hops_histogram->getValueAtPercentile(50) << endl;
+	g_output_file << "Hops p99: " << g_hops_histogram->getValueAtPercentile(99) << endl;
+	g_output_file << "Hops p99.9: " << g_hops_histogram->getValueAtPercentile(99.9) << endl;
 	g_output_file << "Average Total Packet Latency: "
 			<< (g_packet_latency - g_warmup_packet_latency) / receivedPacketCount << endl;
 	g_output_file << "Average Inj Latency: "
@@ -2936,7 +3313,6 @@ void writeOutput() {
 	g_output_file << endl;
 
 	for (int i = 0; i < g_number_switches; i++) {
-		g_switches_list[i]->setQueueOccupancy();
 		for (int vc = 0; vc < g_injection_channels; vc++) {
 			IQO[vc] += g_switches_list[i]->injectionQueueOccupancy[vc];
 		}
@@ -3099,6 +3475,178 @@ void writeOutput() {
 
 	g_output_file << endl;
 	g_output_file.close();
+	if (!g_output_file || rename(partial_file_name.c_str(), g_output_file_name) != 0) {
+		cerr << "Can't write the output file" << g_output_file_name << endl;
+		exit(-1);
+	}
+}
+
+/*
+ * Appends a single JSON record with the results of the run to the
+ * results file. Unlike writeOutput(), values are stored raw (no
+ * per-cycle or per-node normalization) and keyed by stable names,
+ * so that post-processing does not need to parse the text report.
+ */
+void writeResultRecord(const char * results_name) {
+	resultRecord record;
+	map<string, string>::iterator it;
+	int i, vc, sw;
+	long long measured_cycles = g_cycle - g_warmup_cycles;
+
+	record.add("output", g_output_file_name);
+	record.beginObject("config");
+	for (it = g_config_parameters.begin(); it != g_config_parameters.end(); ++it)
+		record.add(it->first, it->second);
+	record.endObject();
+
+	/* Network dimensions */
+	record.add("p", g_p_computing_nodes_per_router);
+	record.add("a", g_a_routers_per_group);
+	record.add("h", g_h_global_ports_per_router);
+	record.add("switches", g_number_switches);
+	record.add("generators", g_number_generators);
+	record.add("ports", g_ports);
+	record.add("flit_size", g_flit_size);
+	record.add("seed", g_seed);
+	record.add("cycles", g_cycle);
+	record.add("warmup_cycles", g_warmup_cycles);
+	record.add("measured_cycles", measured_cycles);
+	if (g_steady_state_detector != NULL) {
+		record.beginObject("steady_state");
+		record.add("converged", g_steady_state_detector->isConverged());
+		record.add("warmup_limit", g_steady_state_detector->getWarmupLimit());
+		record.add("batches", g_steady_state_detector->getBatches());
+		record.beginObject("truncation");
+		for (i = 0; i < steadyStateDetector::NUM_METRICS; i++)
+			record.add(steadyStateDetector::METRIC_NAMES[i], g_steady_state_detector->getTruncation(i));
+		record.endObject();
+		record.endObject();
+	}
+	if (g_batch_means != NULL) {
+		double mean, half_width;
+		record.beginObject("confidence_intervals");
+		record.add("target", g_ci_target);
+		record.add("precision_reached", g_batch_means->isPrecisionReached());
+		record.add("batches", g_batch_means->getBatches());
+		record.add("batch_cycles", g_batch_means->getBatchCycles());
+		for (i = 0; i < batchMeans::NUM_METRICS; i++) {
+			g_batch_means->getInterval(i, mean, half_width);
+			record.beginObject(batchMeans::METRIC_NAMES[i]);
+			record.add("mean", mean);
+			record.add("half_width", half_width);
+			record.add("correlation", g_batch_means->getCorrelation(i));
+			record.endObject();
+		}
+		record.endObject();
+	}
+
+	/* Counters: measured values exclude warmup, which is reported apart */
+	record.beginObject("counters");
+	record.add("tx_flits", g_tx_flit_counter - g_tx_warmup_flit_counter);
+	record.add("tx_flits_warmup", g_tx_warmup_flit_counter);
+	record.add("rx_flits", g_rx_flit_counter - g_rx_warmup_flit_counter);
+	record.add("rx_flits_warmup", g_rx_warmup_flit_counter);
+	record.add("tx_packets", g_tx_packet_counter - g_tx_warmup_packet_counter);
+	record.add("rx_packets", g_rx_packet_counter - g_rx_warmup_packet_counter);
+	record.add("responses", g_response_counter - g_response_warmup_counter);
+	record.add("nonminimal", g_nonminimal_counter - g_nonminimal_warmup_counter);
+	record.add("nonminimal_inj", g_nonminimal_inj - g_nonminimal_warmup_inj);
+	record.add("nonminimal_src", g_nonminimal_src - g_nonminimal_warmup_src);
+	record.add("nonminimal_int", g_nonminimal_int - g_nonminimal_warmup_int);
+	record.add("attended_flits", g_attended_flit_counter);
+	record.addArray("min_flits", g_min_flit_counter, g_allocator_iterations);
+	record.addArray("local_misrouted_flits", g_local_misrouted_flit_counter, g_allocator_iterations);
+	record.addArray("global_misrouted_flits", g_global_misrouted_flit_counter, g_allocator_iterations);
+	record.addArray("global_mandatory_misrouted_flits", g_global_mandatory_misrouted_flit_counter,
+			g_allocator_iterations);
+	record.add("total_hops", g_total_hop_counter);
+	record.add("local_hops", g_local_hop_counter);
+	record.add("global_hops", g_global_hop_counter);
+	record.add("local_ring_hops", g_local_ring_hop_counter);
+	record.add("global_ring_hops", g_global_ring_hop_counter);
+	record.add("local_tree_hops", g_local_tree_hop_counter);
+	record.add("global_tree_hops", g_global_tree_hop_counter);
+	record.add("max_hops", g_max_hops);
+	record.add("max_local_hops", g_max_local_hops);
+	record.add("max_global_hops", g_max_global_hops);
+	record.add("max_local_subnetwork_hops", g_max_local_subnetwork_hops);
+	record.add("max_global_subnetwork_hops", g_max_global_subnetwork_hops);
+	record.add("subnetwork_injections", g_subnetwork_injections_counter);
+	record.add("root_subnetwork_injections", g_root_subnetwork_injections_counter);
+	record.add("source_subnetwork_injections", g_source_subnetwork_injections_counter);
+	record.add("dest_subnetwork_injections", g_dest_subnetwork_injections_counter);
+	record.add("local_contention", g_local_contention_counter);
+	record.add("global_contention", g_global_contention_counter);
+	record.add("local_escape_contention", g_local_escape_contention_counter);
+	record.add("global_escape_contention", g_global_escape_contention_counter);
+	record.add("petitions", (long long) g_petitions);
+	record.add("served_petitions", (long long) g_served_petitions);
+	record.add("injection_petitions", (long long) g_injection_petitions);
+	record.add("served_injection_petitions", (long long) g_served_injection_petitions);
+	record.add("tx_cnm_flits", g_tx_cnmFlit_counter - g_tx_warmup_cnmFlit_counter);
+	record.add("rx_cnm_flits", g_rx_cnmFlit_counter - g_rx_warmup_cnmFlit_counter);
+	record.endObject();
+
+	/* Accumulated latencies (in cycles) */
+	record.beginObject("latency");
+	record.add("flit", g_flit_latency - g_warmup_flit_latency);
+	record.add("flit_warmup", g_warmup_flit_latency);
+	record.add("packet", g_packet_latency - g_warmup_packet_latency);
+	record.add("packet_warmup", g_warmup_packet_latency);
+	record.add("injection", g_injection_queue_latency - g_warmup_injection_latency);
+	record.add("injection_warmup", g_warmup_injection_latency);
+	record.add("base", g_base_latency);
+	record.add("response", g_response_latency);
+	record.endObject();
+
+	record.beginObject("histograms");
+	record.addHistogram("latency_no_global_misroute", *g_latency_histogram_no_global_misroute);
+	record.addHistogram("latency_global_misroute_at_injection", *g_latency_histogram_global_misroute_at_injection);
+	record.addHistogram("latency_other_global_misroute", *g_latency_histogram_other_global_misroute);
+	record.addHistogram("injection_latency", *g_injection_latency_histogram);
+	record.addHistogram("hops", *g_hops_histogram);
+	record.endObject();
+
+	/* Per-port and per-VC usage, aggregated over all switches */
+	record.addArray("port_usage", g_port_usage_counter, g_ports);
+	record.addArray("port_contention", g_port_contention_counter, g_ports);
+	record.beginObject("vc_usage");
+	for (i = 0; i < (int) g_vc_counter.size(); i++)
+		record.addArray(to_string(i), g_vc_counter[i]);
+	record.endObject();
+
+	/* Accumulated queue occupancy per VC (in phits), aggregated over all switches */
+	vector<double> injection_occupancy(g_channels, 0), local_occupancy(g_channels, 0), global_occupancy(g_channels, 0),
+			local_escape_occupancy(g_channels, 0), global_escape_occupancy(g_channels, 0);
+	double output_occupancy = 0;
+	vector<long long> packets_injected(g_number_switches), cnm_packets_injected(g_number_switches);
+	for (sw = 0; sw < g_number_switches; sw++) {
+		for (vc = 0; vc < g_injection_channels; vc++)
+			injection_occupancy[vc] += g_switches_list[sw]->injectionQueueOccupancy[vc];
+		for (vc = 0; vc < g_channels; vc++) {
+			local_occupancy[vc] += g_switches_list[sw]->localQueueOccupancy[vc];
+			global_occupancy[vc] += g_switches_list[sw]->globalQueueOccupancy[vc];
+			local_escape_occupancy[vc] += g_switches_list[sw]->localEscapeQueueOccupancy[vc];
+			global_escape_occupancy[vc] += g_switches_list[sw]->globalEscapeQueueOccupancy[vc];
+		}
+		output_occupancy += g_switches_list[sw]->outputQueueOccupancy;
+		packets_injected[sw] = g_switches_list[sw]->packetsInj;
+		cnm_packets_injected[sw] = g_switches_list[sw]->cnmPacketsInj;
+	}
+	record.beginObject("queue_occupancy");
+	record.addArray("injection", injection_occupancy.data(), g_channels);
+	record.addArray("local", local_occupancy.data(), g_channels);
+	record.addArray("global", global_occupancy.data(), g_channels);
+	record.addArray("local_escape", local_escape_occupancy.data(), g_channels);
+	record.addArray("global_escape", global_escape_occupancy.data(), g_channels);
+	record.add("output", output_occupancy);
+	record.endObject();
+
+	/* Per-switch injections (for fairness analysis) */
+	record.addArray("switch_packets_injected", packets_injected);
+	record.addArray("switch_cnm_packets_injected", cnm_packets_injected);
+
+	record.append(results_name);
 }
 
 void freeMemory() {
@@ -3110,6 +3658,7 @@ void freeMemory() {
 		delete g_switches_list[i];
 	}
 	delete[] g_switches_list;
+	freeSharedTables();
 
 	for (i = 0; i < g_number_generators; i++) {
 		delete g_generators_list[i];
@@ -3152,12 +3701,27 @@ void freeMemory() {
 	delete[] g_groupRoot_numFlits;
 	delete[] g_groupRoot_totalLatency;
 
-	g_latency_histogram_no_global_misroute.clear();
-	g_latency_histogram_global_misroute_at_injection.clear();
-	g_latency_histogram_other_global_misroute.clear();
-
-	delete[] g_hops_histogram;
+	delete g_latency_histogram_no_global_misroute;
+	delete g_latency_histogram_global_misroute_at_injection;
+	delete g_latency_histogram_other_global_misroute;
+	delete g_injection_latency_histogram;
+
+	delete g_hops_histogram;
+	for (i = 0; i < g_trace_prefetchers.size(); i++)
+		delete g_trace_prefetchers[i];
+	for (i = 0; i < g_trace_programs.size(); i++)
+		delete g_trace_programs[i];
+	delete g_trace_scheduler;
 	delete[] g_output_file_name;
+	delete[] g_results_file_name;
+	delete[] g_checkpoint_save_file;
+	delete[] g_checkpoint_restore_file;
+	delete[] g_sweep_key;
+	delete g_metrics_sampler;
+	delete g_steady_state_detector;
+	delete g_batch_means;
+	delete g_packet_tracer;
+	delete g_profiler;
 
 	cout << "Freed memory" << endl;
 }
@@ -3213,11 +3777,16 @@ void writeTransientOutput(char * output_name) {
 	outputFile.close();
 }
 
+/*
+ * Histograms are log-bucketed: below 2^g_histogram_precision every row
+ * corresponds to a single value; above it, each row holds a bucket of
+ * values and is labeled with its lowest value.
+ */
 void writeLatencyHistogram(char * output_name) {
 	string file_name(output_name);
 	ofstream outputFile;
 	int i;
-	long long total_lat;
+	long long total_lat, no_global_misroute, global_misroute_at_injection, other_global_misroute;
 
 	file_name.append(".lat_hist");
 	outputFile.open(file_name.c_str(), ios::out);
@@ -3228,24 +3797,49 @@ void writeLatencyHistogram(char * output_name) {
 	outputFile
 			<< "latency\tnum_packets\tpercent\tnum_packets_no_global_misroute\tpercent_no_global_misroute\tnum_packets_global_misroute_at_injection\tpercent_global_misroute_at_injection\tnum_packets_other_global_misroute\tpercent_other_global_misroute"
 			<< endl;
-	for (i = 0; i < g_latency_histogram_maxLat; i++) {
-		outputFile << i << "\t";
-		total_lat = g_latency_histogram_no_global_misroute[i] + g_latency_histogram_global_misroute_at_injection[i]
-				+ g_latency_histogram_other_global_misroute[i];
+	for (i = 0; i < g_latency_histogram_no_global_misroute->getNumBuckets()
+			&& g_latency_histogram_no_global_misroute->getBucketLowValue(i) < g_latency_histogram_maxLat; i++) {
+		outputFile << g_latency_histogram_no_global_misroute->getBucketLowValue(i) << "\t";
+		no_global_misroute = g_latency_histogram_no_global_misroute->getBucketCount(i);
+		global_misroute_at_injection = g_latency_histogram_global_misroute_at_injection->getBucketCount(i);
+		other_global_misroute = g_latency_histogram_other_global_misroute->getBucketCount(i);
+		total_lat = no_global_misroute + global_misroute_at_injection + other_global_misroute;
 		outputFile << total_lat << "\t";
 		outputFile << ((double) total_lat) / (g_rx_flit_counter - g_rx_warmup_flit_counter) << "\t";
-		outputFile << g_latency_histogram_no_global_misroute[i] << "\t";
-		outputFile
-				<< ((double) g_latency_histogram_no_global_misroute[i]) / (g_rx_flit_counter - g_rx_warmup_flit_counter)
+		outputFile << no_global_misroute << "\t";
+		outputFile << ((double) no_global_misroute) / (g_rx_flit_counter - g_rx_warmup_flit_counter) << "\t";
+		outputFile << global_misroute_at_injection << "\t";
+		outputFile << ((double) global_misroute_at_injection) / (g_rx_flit_counter - g_rx_warmup_flit_counter)
 				<< "\t";
-		outputFile << g_latency_histogram_global_misroute_at_injection[i] << "\t";
-		outputFile
-				<< ((double) g_latency_histogram_global_misroute_at_injection[i])
-						/ (g_rx_flit_counter - g_rx_warmup_flit_counter) << "\t";
-		outputFile << g_latency_histogram_other_global_misroute[i] << "\t";
-		outputFile
-				<< ((double) g_latency_histogram_other_global_misroute[i])
-						/ (g_rx_flit_counter - g_rx_warmup_flit_counter) << "\t";
+		outputFile << other_global_misroute << "\t";
+		outputFile << ((double) other_global_misroute) / (g_rx_flit_counter - g_rx_warmup_flit_counter) << "\t";
+		outputFile << endl;
+	}
+	outputFile.close();
+}
+
+void writeInjectionLatencyHistogram(char * output_name) {
+	string file_name(output_name);
+	ofstream outputFile;
+	int i;
+	long long num_packets;
+
+	file_name.append(".inj_lat_hist");
+	outputFile.open(file_name.c_str(), ios::out);
+	if (!outputFile) {
+		cerr << "Can't open the injection latency histogram output file" << endl;
+		exit(-1);
+	}
+	outputFile << "inj_latency\tnum_packets\tpercent" << endl;
+	for (i = 0; i < g_injection_latency_histogram->getNumBuckets()
+			&& g_injection_latency_histogram->getBucketLowValue(i) <= g_injection_latency_histogram->getMaxValue();
+			i++) {
+		outputFile << g_injection_latency_histogram->getBucketLowValue(i) << "\t";
+
+		num_packets = g_injection_latency_histogram->getBucketCount(i);
+		outputFile << num_packets << "\t";
+		outputFile << ((double) num_packets) / (g_rx_flit_counter - g_rx_warmup_flit_counter);
+
 		outputFile << endl;
 	}
 	outputFile.close();
@@ -3264,10 +3858,11 @@ void writeHopsHistogram(char * output_name) {
 		exit(-1);
 	}
 	outputFile << "hops\tnum_packets\tpercent" << endl;
-	for (i = 0; i < g_hops_histogram_maxHops; i++) {
-		outputFile << i << "\t";
+	for (i = 0; i < g_hops_histogram->getNumBuckets() && g_hops_histogram->getBucketLowValue(i) < g_hops_histogram_maxHops;
+			i++) {
+		outputFile << g_hops_histogram->getBucketLowValue(i) << "\t";
 
-		num_packets = g_hops_histogram[i];
+		num_packets = g_hops_histogram->getBucketCount(i);
 		outputFile << num_packets << "\t";
 		outputFile << ((double) num_packets) / (g_rx_flit_counter - g_rx_warmup_flit_counter);
 
@@ -3453,8 +4048,9 @@ void writeAcorGroup0SwsStatus(char * output_name) {
 }
 
 void readTraceMap(const char * tracemap_filename) {
-	int generator, node, trace, instances;
+	int generator, node, trace;
 	vector < string > values;
+	vector<vector<vector<int> > > layout; // Generators mapped to every trace node, in increasing order
 	ConfigFile map;
 
 	/* Open configuration file */
@@ -3463,16 +4059,9 @@ void readTraceMap(const char * tracemap_filename) {
 		exit(-1);
 	}
 
-	/* Initiate trace2gen map */
-	for (int i = 0; i < g_num_traces; i++) {
-		vector < vector<int> > aux; // Aux vector
-		for (int j = 0; j < g_trace_nodes[i]; j++) {
-			aux.push_back(vector<int>()); // Add an empty vector (will be later increased by every gen mapped to the trace node)
-		}
-		g_trace_2_gen_map.push_back(aux);
-	}
-
 	/* Load trace layout into a map */
+	for (trace = 0; trace < g_num_traces; trace++)
+		layout.push_back(vector<vector<int> >(g_trace_nodes[trace]));
 	for (generator = 0; generator < g_number_generators; generator++) {
 		stringstream strs;
 		strs << generator;
@@ -3481,23 +4070,57 @@ void readTraceMap(const char * tracemap_filename) {
 			assert(trace >= 0 && trace < g_num_traces); // Sanity check
 			node = atoi(values[1].c_str());
 			assert(node >= 0 && node < g_trace_nodes[trace]); // Sanity check
-			g_trace_2_gen_map[trace][node].push_back(generator);
+			layout[trace][node].push_back(generator);
 		}
 	}
 
 	/* Update number of instances */
+	g_trace_instances.resize(g_num_traces);
 	for (trace = 0; trace < g_num_traces; trace++) {
-		instances = g_trace_2_gen_map[trace][0].size();
+		g_trace_instances[trace] = layout[trace][0].size();
 		for (node = 1; node < g_trace_nodes[trace]; node++) {
 #if DEBUG
-			cout << "Traces instances for trace " << trace << " don't match! first node has " << instances
-			<< " copies, node " << node << " has " << g_trace_2_gen_map[trace][node].size() << " copies"
-			<< endl;
+			cout << "Traces instances for trace " << trace << " don't match! first node has "
+			<< g_trace_instances[trace] << " copies, node " << node << " has " << layout[trace][node].size()
+			<< " copies" << endl;
 #endif
-			assert(instances == g_trace_2_gen_map[trace][node].size()); // Sanity check: # of instances must be same for all nodes in a trace
+			assert(g_trace_instances[trace] == layout[trace][node].size()); // Sanity check: # of instances must be same for all nodes in a trace
 		}
-		g_trace_instances.push_back(instances);
 	}
+
+	/* Build the flat trace maps; instances are numbered by generator id */
+	initTraceMap();
+	for (trace = 0; trace < g_num_traces; trace++)
+		for (node = 0; node < g_trace_nodes[trace]; node++)
+			for (int instance = 0; instance < g_trace_instances[trace]; instance++)
+				mapTraceNode(trace, node, instance, layout[trace][node][instance]);
+}
+
+/* Sizes the trace maps upon the number of nodes and instances of every trace,
+ * with no generator assigned yet.
+ */
+void initTraceMap() {
+	int trace, entries = 0;
+	TraceNodeId unmapped = { -1, -1, -1 };
+
+	g_gen_2_trace_map.assign(g_number_generators, unmapped);
+	g_trace_2_gen_offset.clear();
+	for (trace = 0; trace < g_num_traces; trace++) {
+		g_trace_2_gen_offset.push_back(entries);
+		entries += g_trace_nodes[trace] * g_trace_instances[trace];
+	}
+	g_trace_2_gen_map.assign(entries, -1);
+}
+
+/* Assigns a generator to an instance of a trace node, in both directions.
+ */
+void mapTraceNode(int trace, int node, int instance, int generator) {
+	assert(generator >= 0 && generator < g_number_generators); // Sanity check
+	assert(g_gen_2_trace_map[generator].trace_id == -1); // Every generator runs one trace node at most
+	g_gen_2_trace_map[generator].trace_id = trace;
+	g_gen_2_trace_map[generator].trace_node = node;
+	g_gen_2_trace_map[generator].instance = instance;
+	g_trace_2_gen_map[g_trace_2_gen_offset[trace] + instance * g_trace_nodes[trace] + node] = generator;
 }
 
 /* Constructs trace layout/map (linking every trace node to a generator)
@@ -3506,7 +4129,7 @@ void readTraceMap(const char * tracemap_filename) {
  * reuse it for future simulations).
  */
 void buildTraceMap() {
-	int i, j, trace, instance, node, generator;
+	int i, trace, instance, node, generator;
 	string fileName(g_output_file_name);
 	ofstream traceMapFile;
 	assert(g_num_traces > 0);
@@ -3517,14 +4140,7 @@ void buildTraceMap() {
 	traceMapFile.open(fileName.c_str(), ios::out);
 	traceMapFile << "[TRACE_MAP]" << endl;
 
-	/* Initiate trace2gen map */
-	for (i = 0; i < g_num_traces; i++) {
-		vector < vector<int> > aux; // Aux vector
-		for (j = 0; j < g_trace_nodes[i]; j++) {
-			aux.push_back(vector<int>()); // Add an empty vector (will be later increased by every gen mapped to the trace node)
-		}
-		g_trace_2_gen_map.push_back(aux);
-	}
+	initTraceMap();
 
 	/* Associate every trace node with a generator */
 	for (trace = 0; trace < g_num_traces; trace++) {
@@ -3553,22 +4169,20 @@ void buildTraceMap() {
 					case RANDOM:
 						do
 							generator = rand() % g_number_generators;
-						while (g_gen_2_trace_map.count(generator) == 1);
+						while (g_gen_2_trace_map[generator].trace_id != -1);
 						break;
 					default:
 						assert(0);
 						break;
 				}
-				assert(generator >= 0 && generator < g_number_generators); // Sanity check
-				g_trace_2_gen_map[trace][node].push_back(generator);
-				assert(g_gen_2_trace_map.insert(pair<int, TraceNodeId>(generator, { trace, node })).second == true);
+				mapTraceNode(trace, node, instance, generator);
 			}
 		}
 	}
 
 	/* Save trace map to file */
 	for (generator = 0; generator < g_number_generators; generator++) {
-		if (g_gen_2_trace_map.count(generator) > 0) {
+		if (g_gen_2_trace_map[generator].trace_id != -1) {
 			traceMapFile << generator << "=" << g_gen_2_trace_map[generator].trace_id << ","
 					<< g_gen_2_trace_map[generator].trace_node << endl;
 		}
@@ -3735,6 +4349,16 @@ void readTraceDistribution(const char * t_d, TraceAssignation * var) {
 	}
 }
 
+void readCollectiveAlgorithm(const char * c_a, CollectiveAlgorithm * var) {
+	READ_ENUM(c_a, LINEAR_COLL) else
+	READ_ENUM(c_a, BINOMIAL_COLL) else
+	READ_ENUM(c_a, RING_COLL) else
+	READ_ENUM(c_a, RDOUBLING_COLL) else {
+		cerr << "ERROR: UNRECOGNISED COLLECTIVE ALGORITHM!" << endl;
+		exit(0);
+	}
+}
+
 void readVcUsage(const char * v_u, VcUsageType * var) {
 	READ_ENUM(v_u, BASE) else
 	READ_ENUM(v_u, FLEXIBLE) else
@@ -3794,6 +4418,24 @@ void readQCNSWPolicy(const char * q_s_p, QcnSwPolicy * var) {
 	}
 }
 
+void readResultsFormat(const char * r_f, ResultsFormat * var) {
+	READ_ENUM(r_f, TEXT) else
+	READ_ENUM(r_f, JSONL) else
+	READ_ENUM(r_f, TEXT_JSONL) else {
+		cerr << "ERROR: UNRECOGNISED RESULTS FORMAT!" << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+void readCIMetric(const char * c_m, CIMetric * var) {
+	READ_ENUM(c_m, FLIT_LATENCY) else
+	READ_ENUM(c_m, PACKET_LATENCY) else
+	READ_ENUM(c_m, ACCEPTED_LOAD) else {
+		cerr << "ERROR: UNRECOGNISED CONFIDENCE INTERVAL METRIC!" << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
 void readACORStateManagement(const char * a_s_m, acorStateManagement * var) {
     READ_ENUM(a_s_m, PACKETCGCSRS) else
     READ_ENUM(a_s_m, PACKETCGRS) else
@@ -24,12 +24,17 @@
 int module(int a, int b);
 bool parity(int a, int b);
 int main(int argc, char *argv[]);
+void openOutputFile();
 void readConfiguration(int argc, char *argv[]);
 void createNetwork();
+bool isProgressPrintDue();
+void checkEventDeadlock();
 void action();
 void writeOutput();
+void writeResultRecord(const char * results_name);
 void writeTransientOutput(char * output_name);
 void writeLatencyHistogram(char * output_name);
+void writeInjectionLatencyHistogram(char * output_name);
 void writeHopsHistogram(char * output_name);
 void writeGeneratorsInjectionProbability(char * output_name);
 void writeQcnPortEnruteMinProbability(char * output_name);
@@ -50,6 +55,7 @@ void readDeadlockAvoidanceMechanism(const char * d_a, DeadlockAvoidance * var);
 void readMisroutingTrigger(const char * m_t, MisroutingTrigger * var);
 void readCongestionDetection(const char * c_d, CongestionDetection * var);
 void readTraceDistribution(const char * t_d, TraceAssignation * var);
+void readCollectiveAlgorithm(const char * c_a, CollectiveAlgorithm * var);
 void readVcUsage(const char * v_u, VcUsageType * var);
 void readVcAlloc(const char * v_a, VcAllocationMechanism * var);
 void readVcInj(const char * v_i, VcInjectionPolicy * var);
@@ -57,5 +63,9 @@ void readCongestionManagement(const char * c_m, CongestionManagement * var);
 void readQCNSWImplementation(const char * q_s_i, QcnSwImplementation * var);
 void readQCNSWPolicy(const char * qcn_sw_pol, QcnSwPolicy * var);
 void readACORStateManagement(const char * a_s_m, acorStateManagement * var);
+void readResultsFormat(const char * r_f, ResultsFormat * var);
+void readCIMetric(const char * c_m, CIMetric * var);
 void readTraceMap(const char * tracemap_filename);
+void initTraceMap();
+void mapTraceNode(int trace, int node, int instance, int generator);
 void buildTraceMap();
@@ -19,6 +19,7 @@
  */
 
 #include "caFlit.h"
+#include "../checkpoint.h"
 
 long long caFlit::id = 0;
 
@@ -58,3 +59,11 @@ caFlit::~caFlit() {
 float caFlit::getArrivalCycle() const {
 	return m_arrivalCycle;
 }
+
+void caFlit::checkpoint(checkpointFile &ckpt) {
+	ckpt.array(partial_counter, g_a_routers_per_group * g_h_global_ports_per_router + 1);
+	ckpt.value(m_aPos);
+	ckpt.value(m_arrivalCycle);
+	ckpt.value(m_generatedCycle);
+	ckpt.value(m_id);
+}
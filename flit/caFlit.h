@@ -23,12 +23,15 @@
 
 #include "../global.h"
 
+class checkpointFile;
+
 class caFlit {
 public:
 	caFlit(int aPos, int * counter, float arrivalCycle);
 	caFlit(const caFlit& original);
 	~caFlit();
 	float getArrivalCycle() const;
+	void checkpoint(checkpointFile &ckpt);
 
 	static long long id;
 	int * partial_counter;
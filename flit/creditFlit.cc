@@ -19,6 +19,7 @@
  */
 
 #include "creditFlit.h"
+#include "../checkpoint.h"
 
 creditFlit::creditFlit(float arrivalCycle, int numCreds, int numMinCreds, unsigned short cos, int vc, int flitId) :
 		m_arrivalCycle(arrivalCycle), m_numCreds(numCreds), m_numMinCreds(numMinCreds), m_cos(cos), m_vc(vc), m_flitId(
@@ -59,3 +60,11 @@ int creditFlit::getFlitId() const {
 	return m_flitId;
 }
 
+void creditFlit::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(m_arrivalCycle);
+	ckpt.value(m_numCreds);
+	ckpt.value(m_numMinCreds);
+	ckpt.value(m_cos);
+	ckpt.value(m_vc);
+	ckpt.value(m_flitId);
+}
@@ -21,6 +21,8 @@
 #ifndef CREDITMSG_H
 #define	CREDITMSG_H
 
+class checkpointFile;
+
 class creditFlit {
 public:
 	creditFlit(float arrivalCycle, int numCreds, int numMinCreds, unsigned short cos, int vc, int flitId);
@@ -32,6 +34,7 @@ public:
 	float getArrivalCycle() const;
 	bool operator <(const creditFlit& flit) const; /* Priority comparation */
 	int getFlitId() const;
+	void checkpoint(checkpointFile &ckpt);
 private:
 	float m_arrivalCycle;
 	int m_numCreds;
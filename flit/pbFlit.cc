@@ -19,6 +19,7 @@
  */
 
 #include "pbFlit.h"
+#include "../checkpoint.h"
 
 long long pbFlit::id = 0;
 
@@ -100,3 +101,12 @@ float pbFlit::GetGeneratedCycle() const {
 	return m_generatedCycle;
 }
 
+void pbFlit::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(m_srcOffset);
+	for (int i = 0; i < g_h_global_ports_per_router; i++)
+		for (int cos = 0; cos < g_cos_levels; cos++)
+			ckpt.array(m_globalLinkInfo[i][cos], g_global_link_channels);
+	ckpt.value(m_arrivalCycle);
+	ckpt.value(m_generatedCycle);
+	ckpt.value(m_id);
+}
@@ -24,6 +24,7 @@
 #include "../global.h"
 
 class creditFlit;
+class checkpointFile;
 
 /* 
  * PiggyBacking Message: 
@@ -42,6 +43,7 @@ public:
 	bool operator <(const pbFlit& flit) const;
 	long long getId() const;
 	float GetGeneratedCycle() const;
+	void checkpoint(checkpointFile &ckpt);
 
 	static long long id;
 
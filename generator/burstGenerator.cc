@@ -19,6 +19,7 @@
  */
 
 #include "burstGenerator.h"
+#include "../checkpoint.h"
 #include <math.h>
 
 burstGenerator::burstGenerator(int interArrivalTime, string name, int sourceLabel, int pPos, int aPos, int hPos,
@@ -27,10 +28,7 @@ burstGenerator::burstGenerator(int interArrivalTime, string name, int sourceLabe
 	/* Currently this generator type is only aimed to uniform random
 	 * traffic pattern; could be updated in future revisions. */
 	assert(g_traffic == BURSTY_UN);
-	pOn2Off = (double) 1 / g_bursty_avg_length;
-	double pON = (double) g_injection_probability / (100 * g_packet_size);
-	pOff2On = pON / (g_bursty_avg_length + pON * (1 - g_bursty_avg_length));
-	assert(fabs(pOff2On) <= 1 && fabs(pOn2Off) <= 1);
+	setInjectionProbability(g_injection_probability);
 	injecting = false; /* Initial state is 'Off' (not sending) */
 	prevDest = -1; /* To prevent errors, initial destination is not valid */
 	curBurstLength = 0;
@@ -40,6 +38,15 @@ burstGenerator::~burstGenerator() {
 
 }
 
+/* Change-of-state probabilities are derived from the injection probability */
+void burstGenerator::setInjectionProbability(float newInjectionProbability) {
+	generatorModule::setInjectionProbability(newInjectionProbability);
+	pOn2Off = (double) 1 / g_bursty_avg_length;
+	double pON = (double) newInjectionProbability / (100 * g_packet_size);
+	pOff2On = pON / (g_bursty_avg_length + pON * (1 - g_bursty_avg_length));
+	assert(fabs(pOff2On) <= 1 && fabs(pOn2Off) <= 1);
+}
+
 /* Generates a new flit if injection probability triggers it, and
  * the injection buffer has enough space. It has 2 different
  * status (injecting / not injecting) and can change destination
@@ -82,7 +89,7 @@ flitModule* burstGenerator::generateFlit(FlitType flitType, int destId) {
 		/* Generate petition packet */
 		if ((g_cycle == 0 || g_cycle >= (lastTimeSent + interArrivalTime))) {
 			/* Determine current cycle status */
-			double random = rand() / ((double) RAND_MAX + 1);
+			double random = trafficRand() / ((double) RAND_MAX + 1);
 			if (!injecting) { /* Current status: OFF */
 				if (random < (double) pOff2On) {
 					injecting = true;
@@ -94,7 +101,7 @@ flitModule* burstGenerator::generateFlit(FlitType flitType, int destId) {
 			} else if (switchM->switchModule::getCredits(this->pPos, 0, m_injVC) >= g_packet_size) {
 				/* Current status: ON */
 				if (random < pOn2Off) {
-					random = rand() / ((double) RAND_MAX + 1);
+					random = trafficRand() / ((double) RAND_MAX + 1);
 					if (random < pOff2On) {
 						destLabel = pattern->setDestination(UN);
 						prevDest = destLabel;
@@ -135,3 +142,10 @@ flitModule* burstGenerator::generateFlit(FlitType flitType, int destId) {
 	return genFlit;
 }
 
+/* On/Off transition probabilities derive from the injection probability, so they are not stored */
+void burstGenerator::checkpoint(checkpointFile &ckpt) {
+	generatorModule::checkpoint(ckpt);
+	ckpt.value(injecting);
+	ckpt.value(prevDest);
+	ckpt.value(curBurstLength);
+}
@@ -38,6 +38,8 @@ public:
 			switchModule *switchM);
 	~burstGenerator();
 	flitModule* generateFlit(FlitType flitType = RESPONSE, int destId = -1);
+	void setInjectionProbability(float newInjectionProbability);
+	void checkpoint(checkpointFile &ckpt);
 };
 
 #endif /* BURSTGENERATOR_H_ */
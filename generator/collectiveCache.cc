@@ -0,0 +1,274 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "collectiveCache.h"
+#include "trace.h"
+
+/*
+ * Linear broadcast: root sends the message to every rank (itself included).
+ */
+void collectiveAlgorithm::bcast(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	if (rank == root) {
+		for (long t = 0; t < size; t++)
+			addStep(steps, SENDING, t, sendsize);
+	} else {
+		addStep(steps, RECEPTION, root, recvsize);
+	}
+}
+
+/*
+ * Linear reduce: root receives the message of every other rank.
+ */
+void collectiveAlgorithm::reduce(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	if (rank == root) {
+		for (long t = 0; t < size; t++)
+			if (t != root) addStep(steps, RECEPTION, t, recvsize);
+	} else {
+		addStep(steps, SENDING, root, sendsize);
+	}
+}
+
+void collectiveAlgorithm::allToAll(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	exchange(size, rank, sendsize, steps);
+}
+
+void collectiveAlgorithm::allReduce(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	exchange(size, rank, sendsize, steps);
+}
+
+/*
+ * A barrier is modeled as an allreduce of its (small) message.
+ */
+void collectiveAlgorithm::barrier(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	allReduce(size, rank, sendsize, steps);
+}
+
+/*
+ * Pairwise exchange with every other rank, in size-1 strides. Ranks pair
+ * up alternately forwards and backwards, so that both ends of every pair
+ * address each other in the same stride.
+ */
+void collectiveAlgorithm::exchange(long size, long rank, long length, vector<collective_step> &steps) {
+	long stride, g, t;
+	for (stride = 1; stride < size; stride++) {
+		g = gcd(stride, size);
+		if ((rank / g) & 1)
+			t = (rank + size - stride) % size;
+		else
+			t = (rank + stride) % size;
+		addStep(steps, SENDING, t, length);
+		addStep(steps, RECEPTION, t, length);
+	}
+}
+
+/*
+ * Binomial broadcast: every rank receives from its parent and forwards the
+ * message to its subtrees, largest first.
+ */
+void binomialCollective::bcast(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	long vrank = (rank - root + size) % size, mask = 1, length = sendsize;
+	while (mask < size) {
+		if (vrank & mask) {
+			addStep(steps, RECEPTION, (vrank - mask + root) % size, recvsize);
+			length = recvsize;
+			break;
+		}
+		mask <<= 1;
+	}
+	for (mask >>= 1; mask > 0; mask >>= 1)
+		if (vrank + mask < size) addStep(steps, SENDING, (vrank + mask + root) % size, length);
+}
+
+/*
+ * Binomial reduce: every rank receives from its subtrees, smallest first,
+ * and sends the partial result to its parent.
+ */
+void binomialCollective::reduce(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	long vrank = (rank - root + size) % size, mask;
+	for (mask = 1; mask < size; mask <<= 1) {
+		if (vrank & mask) {
+			addStep(steps, SENDING, (vrank - mask + root) % size, sendsize);
+			break;
+		}
+		if (vrank + mask < size)
+			addStep(steps, RECEPTION, (vrank + mask + root) % size, (vrank == 0) ? recvsize : sendsize);
+	}
+}
+
+void binomialCollective::allReduce(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	reduce(size, 0, rank, sendsize, sendsize, steps);
+	bcast(size, 0, rank, sendsize, sendsize, steps);
+}
+
+/*
+ * Chain broadcast: the message is forwarded along the ring, from root.
+ */
+void ringCollective::bcast(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	long vrank = (rank - root + size) % size;
+	if (vrank > 0) addStep(steps, RECEPTION, (rank + size - 1) % size, recvsize);
+	if (vrank < size - 1) addStep(steps, SENDING, (rank + 1) % size, (vrank == 0) ? sendsize : recvsize);
+}
+
+/*
+ * Chain reduce: partial results flow backwards along the ring, towards root.
+ */
+void ringCollective::reduce(long size, long root, long rank, long sendsize, long recvsize,
+		vector<collective_step> &steps) {
+	long vrank = (rank - root + size) % size;
+	if (vrank < size - 1) addStep(steps, RECEPTION, (rank + 1) % size, (vrank == 0) ? recvsize : sendsize);
+	if (vrank > 0) addStep(steps, SENDING, (rank + size - 1) % size, sendsize);
+}
+
+/*
+ * Shifted exchange: in step i, send to rank+i and receive from rank-i.
+ */
+void ringCollective::allToAll(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	for (long i = 1; i < size; i++) {
+		addStep(steps, SENDING, (rank + i) % size, sendsize);
+		addStep(steps, RECEPTION, (rank + size - i) % size, sendsize);
+	}
+}
+
+/*
+ * Ring allreduce: a reduce-scatter followed by an allgather, each in size-1
+ * steps that pass one size-th of the message to the next rank.
+ */
+void ringCollective::allReduce(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	long chunk = max((sendsize + size - 1) / size, 1L);
+	for (long i = 0; i < 2 * (size - 1); i++) {
+		addStep(steps, SENDING, (rank + 1) % size, chunk);
+		addStep(steps, RECEPTION, (rank + size - 1) % size, chunk);
+	}
+}
+
+/*
+ * Bruck alltoall: in step k, blocks whose index has bit k set are sent to
+ * rank+2^k (and received from rank-2^k).
+ */
+void rdoublingCollective::allToAll(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	for (long k = 1; k < size; k <<= 1) {
+		long blocks = 0;
+		for (long j = 0; j < size; j++)
+			if (j & k) blocks++;
+		addStep(steps, SENDING, (rank + k) % size, blocks * sendsize);
+		addStep(steps, RECEPTION, (rank + size - k) % size, blocks * sendsize);
+	}
+}
+
+/*
+ * Recursive doubling allreduce: ranks exchange with rank XOR 2^k. When size
+ * is not a power of two, the extra ranks first hand their message to a
+ * partner among the lower ones, and get the result back at the end.
+ */
+void rdoublingCollective::allReduce(long size, long rank, long sendsize, vector<collective_step> &steps) {
+	long pof2 = 1, rem, mask;
+	while (pof2 * 2 <= size)
+		pof2 *= 2;
+	rem = size - pof2;
+	if (rank >= pof2) {
+		addStep(steps, SENDING, rank - pof2, sendsize);
+		addStep(steps, RECEPTION, rank - pof2, sendsize);
+		return;
+	}
+	if (rank < rem) addStep(steps, RECEPTION, rank + pof2, sendsize);
+	for (mask = 1; mask < pof2; mask <<= 1) {
+		addStep(steps, SENDING, rank ^ mask, sendsize);
+		addStep(steps, RECEPTION, rank ^ mask, sendsize);
+	}
+	if (rank < rem) addStep(steps, SENDING, rank + pof2, sendsize);
+}
+
+collectiveCache::collectiveCache(CollectiveAlgorithm algorithm) {
+	switch (algorithm) {
+		case BINOMIAL_COLL:
+			m_algorithm = new binomialCollective();
+			break;
+		case RING_COLL:
+			m_algorithm = new ringCollective();
+			break;
+		case RDOUBLING_COLL:
+			m_algorithm = new rdoublingCollective();
+			break;
+		default:
+			m_algorithm = new collectiveAlgorithm();
+			break;
+	}
+	m_hits = 0;
+}
+
+collectiveCache::~collectiveCache() {
+	delete m_algorithm;
+}
+
+bool collectiveCache::scheduleKey::operator<(const scheduleKey& other) const {
+	if (type != other.type) return type < other.type;
+	if (size != other.size) return size < other.size;
+	if (root != other.root) return root < other.root;
+	if (sendsize != other.sendsize) return sendsize < other.sendsize;
+	return recvsize < other.recvsize;
+}
+
+/*
+ * Returns the schedule of a rank in a collective (over communicator ranks),
+ * expanding it only the first time. Collectives with no root take root 0.
+ */
+const vector<collective_step>& collectiveCache::getSchedule(int type, long size, long root, long rank, long sendsize,
+		long recvsize) {
+	scheduleKey key = { type, size, root, sendsize, recvsize };
+	scheduleTemplate &schedule = m_templates[key];
+
+	assert(rank >= 0 && rank < size && root >= 0 && root < size);
+	if (schedule.built.empty()) {
+		schedule.ranks.resize(size);
+		schedule.built.assign(size, false);
+	}
+	if (schedule.built[rank]) {
+		m_hits++;
+		return schedule.ranks[rank];
+	}
+	switch (type) {
+		case EV_MPI_Bcast:
+			m_algorithm->bcast(size, root, rank, sendsize, recvsize, schedule.ranks[rank]);
+			break;
+		case EV_MPI_Reduce:
+			m_algorithm->reduce(size, root, rank, sendsize, recvsize, schedule.ranks[rank]);
+			break;
+		case EV_MPI_Alltoall:
+		case EV_MPI_Alltoallv:
+			m_algorithm->allToAll(size, rank, sendsize, schedule.ranks[rank]);
+			break;
+		case EV_MPI_Allreduce:
+			m_algorithm->allReduce(size, rank, sendsize, schedule.ranks[rank]);
+			break;
+		case EV_MPI_Barrier:
+			m_algorithm->barrier(size, rank, sendsize, schedule.ranks[rank]);
+			break;
+		default:
+			cerr << "Implement me!" << endl;
+			assert(0);
+	}
+	schedule.built[rank] = true;
+	return schedule.ranks[rank];
+}
@@ -0,0 +1,125 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef COLLECTIVECACHE_H_
+#define COLLECTIVECACHE_H_
+
+#include "../global.h"
+#include "event.h"
+
+/*
+ * A step of a collective schedule, as seen by one of its ranks: a message
+ * sent to or received from another rank of the communicator.
+ */
+typedef struct collective_step {
+	event_t type;	///< SENDING or RECEPTION.
+	long peer;		///< The other rank in the communicator.
+	long length;	///< Length of the message in packets.
+} collective_step;
+
+/*
+ * Expansion of MPI collectives into point-to-point messages. The base class
+ * implements the linear algorithms (root sends to/receives from every rank,
+ * pairwise exchanges for all-to-all operations); derived algorithms override
+ * the collectives they implement differently. Schedules are computed over
+ * communicator ranks, with root at the given rank.
+ */
+class collectiveAlgorithm {
+public:
+	virtual ~collectiveAlgorithm() {
+	}
+	virtual void bcast(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	virtual void reduce(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	virtual void allToAll(long size, long rank, long sendsize, vector<collective_step> &steps);
+	virtual void allReduce(long size, long rank, long sendsize, vector<collective_step> &steps);
+	virtual void barrier(long size, long rank, long sendsize, vector<collective_step> &steps);
+protected:
+	void exchange(long size, long rank, long length, vector<collective_step> &steps);
+	static inline void addStep(vector<collective_step> &steps, event_t type, long peer, long length) {
+		collective_step step = { type, peer, length };
+		steps.push_back(step);
+	}
+};
+
+/* Binomial trees for rooted collectives; allreduce (and barrier) as a reduce
+ * to rank 0 followed by a broadcast from it. */
+class binomialCollective: public collectiveAlgorithm {
+public:
+	void bcast(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	void reduce(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	void allReduce(long size, long rank, long sendsize, vector<collective_step> &steps);
+};
+
+/* Pipelined chains for rooted collectives, shifted exchanges for alltoall and
+ * reduce-scatter plus allgather rings for allreduce (and barrier). */
+class ringCollective: public collectiveAlgorithm {
+public:
+	void bcast(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	void reduce(long size, long root, long rank, long sendsize, long recvsize, vector<collective_step> &steps);
+	void allToAll(long size, long rank, long sendsize, vector<collective_step> &steps);
+	void allReduce(long size, long rank, long sendsize, vector<collective_step> &steps);
+};
+
+/* Recursive doubling allreduce (and barrier) and Bruck alltoall, both in
+ * ceil(log2(size)) steps; rooted collectives use binomial trees. */
+class rdoublingCollective: public binomialCollective {
+public:
+	void allToAll(long size, long rank, long sendsize, vector<collective_step> &steps);
+	void allReduce(long size, long rank, long sendsize, vector<collective_step> &steps);
+};
+
+/*
+ * Memoizes collective expansions. Iterative applications repeat the same
+ * collectives over and over, so schedules are computed once per collective
+ * type, communicator size, root rank and message sizes, and kept as
+ * per-rank templates; they are instantiated for any communicator by mapping
+ * ranks to its processes.
+ */
+class collectiveCache {
+public:
+	collectiveCache(CollectiveAlgorithm algorithm);
+	~collectiveCache();
+	const vector<collective_step>& getSchedule(int type, long size, long root, long rank, long sendsize,
+			long recvsize);
+	inline long getNumTemplates() const {
+		return m_templates.size();
+	}
+	inline long getNumHits() const {
+		return m_hits;
+	}
+private:
+	struct scheduleKey {
+		int type;
+		long size;
+		long root;
+		long sendsize;
+		long recvsize;
+		bool operator<(const scheduleKey& other) const;
+	};
+	struct scheduleTemplate {
+		vector<vector<collective_step> > ranks; /* Schedule of every rank */
+		vector<bool> built; /* Ranks are expanded on demand */
+	};
+	collectiveAlgorithm *m_algorithm;
+	map<scheduleKey, scheduleTemplate> m_templates;
+	long m_hits;
+};
+
+#endif /* COLLECTIVECACHE_H_ */
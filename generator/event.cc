@@ -21,6 +21,261 @@
 
 #include "event.h"
 #include "generatorModule.h"
+#include "tracePrefetcher.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Binary trace layout: this header, followed by numTasks + 1 task offsets
+ * (int64) and numEvents packed events, both in native byte order. Event
+ * lengths depend on the parameters used to translate the trace, so they
+ * are recorded and checked against the ones in use when loading.
+ */
+#define BINARY_TRACE_MAGIC "FOGTRACE"
+#define BINARY_TRACE_VERSION 2
+#define BINARY_TRACE_BYTE_ORDER 0x01020304
+
+static_assert(sizeof(long) == sizeof(int64_t), "Binary traces store task offsets as 64-bit longs");
+
+typedef struct binary_trace_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t eventSize;
+	uint32_t cutmpi;
+	uint32_t collectiveAlgorithm;
+	int64_t numTasks;
+	int64_t numEvents;
+	int64_t packetSize;
+	int64_t phitSize;
+	int64_t opPerCycle;
+	double cpuSpeed;
+} binary_trace_header;
+
+traceProgram::traceProgram(int numTasks, const char *spillFile, long spillBudget) {
+	assert(numTasks > 0);
+	m_numTasks = numTasks;
+	m_numEvents = 0;
+	m_pending.resize(numTasks);
+	m_offsets.assign(numTasks + 1, 0);
+	m_data = NULL;
+	m_offsetsData = m_offsets.data();
+	m_map = NULL;
+	m_mapLength = 0;
+	m_spill = NULL;
+	m_spillBudget = spillBudget;
+	m_pendingEvents = 0;
+	if (spillFile != NULL) {
+		assert(spillBudget > 0);
+		m_spillFile = spillFile;
+		if ((m_spill = fopen(spillFile, "w+b")) == NULL) {
+			cerr << "Can't open the trace spill file: " << spillFile << endl;
+			exit(-1);
+		}
+		m_chunks.resize(numTasks);
+	}
+}
+
+/**
+ * Maps a binary trace into memory (read only, shared among instances).
+ */
+traceProgram::traceProgram(const char *binaryFile) {
+	int fd;
+	struct stat st;
+	const binary_trace_header *header;
+
+	m_map = NULL;
+	m_mapLength = 0;
+	m_spill = NULL;
+	m_spillBudget = m_pendingEvents = 0;
+	if ((fd = open(binaryFile, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+		cerr << "Can't open the binary trace file: " << binaryFile << endl;
+		exit(-1);
+	}
+	m_mapLength = st.st_size;
+	if (m_mapLength < sizeof(binary_trace_header)
+			|| (m_map = mmap(NULL, m_mapLength, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		cerr << "Can't map the binary trace file: " << binaryFile << endl;
+		exit(-1);
+	}
+	close(fd);
+
+	header = (const binary_trace_header *) m_map;
+	if (strncmp(header->magic, BINARY_TRACE_MAGIC, 8) != 0 || header->version != BINARY_TRACE_VERSION
+			|| header->byteOrder != BINARY_TRACE_BYTE_ORDER || header->eventSize != sizeof(packed_event)) {
+		cerr << "Unsupported binary trace file (version/byte order/event size mismatch): " << binaryFile << endl;
+		exit(-1);
+	}
+	if (header->packetSize != g_packet_size || header->phitSize != g_phit_size
+			|| header->opPerCycle != g_op_per_cycle || header->cpuSpeed != g_cpu_speed
+			|| header->cutmpi != g_cutmpi || header->collectiveAlgorithm != g_collective_algorithm) {
+		cerr << "Binary trace " << binaryFile << " was converted with different parameters (PacketSize="
+				<< header->packetSize << ", phit_size=" << header->phitSize << ", cpu_speed=" << header->cpuSpeed
+				<< ", op_per_cycle=" << header->opPerCycle << ", cutmpi=" << header->cutmpi
+				<< ", collective_algorithm=" << header->collectiveAlgorithm << ")" << endl;
+		exit(-1);
+	}
+	m_numTasks = header->numTasks;
+	m_numEvents = header->numEvents;
+	if (m_mapLength != sizeof(binary_trace_header) + (m_numTasks + 1) * sizeof(long)
+			+ m_numEvents * sizeof(packed_event)) {
+		cerr << "Truncated binary trace file: " << binaryFile << endl;
+		exit(-1);
+	}
+	m_offsetsData = (const long *) ((const char *) m_map + sizeof(binary_trace_header));
+	m_data = (const packed_event *) (m_offsetsData + m_numTasks + 1);
+}
+
+traceProgram::~traceProgram() {
+	if (m_map != NULL) munmap(m_map, m_mapLength);
+	if (m_spill != NULL) {
+		fclose(m_spill);
+		unlink(m_spillFile.c_str());
+	}
+}
+
+/**
+ * Appends an event to the stream of a task (only before sealing the program).
+ */
+void traceProgram::addEvent(int task, const event& ev) {
+	packed_event p;
+	assert(task >= 0 && task < m_numTasks);
+	assert(m_map == NULL);
+	memset(&p, 0, sizeof(p)); /* Padding is also saved in binary traces */
+	assert(ev.pid >= INT_MIN && ev.pid <= INT_MAX && ev.task >= INT_MIN && ev.task <= INT_MAX);
+	p.length = ev.length;
+	p.pid = ev.pid;
+	p.task = ev.task;
+	p.type = ev.type;
+	p.mpitype = ev.mpitype;
+	m_pending[task].push_back(p);
+	if (m_spill != NULL && ++m_pendingEvents >= m_spillBudget) spill();
+}
+
+/**
+ * Flushes the events held for every task to the spill file, as one chunk per task.
+ */
+void traceProgram::spill() {
+	assert(m_spill != NULL);
+	for (int task = 0; task < m_numTasks; task++) {
+		if (m_pending[task].empty()) continue;
+		fseeko(m_spill, 0, SEEK_END);
+		m_chunks[task].push_back(make_pair(ftello(m_spill), (long) m_pending[task].size()));
+		if (fwrite(m_pending[task].data(), sizeof(packed_event), m_pending[task].size(), m_spill)
+				!= m_pending[task].size()) {
+			cerr << "Error writing the trace spill file: " << m_spillFile << endl;
+			exit(-1);
+		}
+		vector<packed_event>().swap(m_pending[task]);
+	}
+	m_pendingEvents = 0;
+}
+
+/**
+ * Drops every event parsed so far for a task (used with g_cutmpi at MPI_Init).
+ */
+void traceProgram::clearTask(int task) {
+	assert(task >= 0 && task < m_numTasks);
+	vector<packed_event>().swap(m_pending[task]);
+	if (m_spill != NULL) m_chunks[task].clear(); /* Spilled events are just left unreferenced */
+}
+
+/**
+ * Flattens the per-task streams into a single array, indexed by task offsets.
+ * Each task list is freed as soon as it is appended, so that peak memory is
+ * the event data plus the largest task list rather than twice the event data.
+ */
+void traceProgram::seal() {
+	int task;
+	long total = 0;
+	if (m_spill != NULL) {
+		/* Events stay in the spill file; only task offsets are computed */
+		spill();
+		for (task = 0; task < m_numTasks; task++) {
+			m_offsets[task] = total;
+			for (unsigned int c = 0; c < m_chunks[task].size(); c++)
+				total += m_chunks[task][c].second;
+		}
+		m_offsets[m_numTasks] = m_numEvents = total;
+		vector<vector<packed_event> >().swap(m_pending);
+		m_offsetsData = m_offsets.data();
+		return;
+	}
+	for (task = 0; task < m_numTasks; task++)
+		total += m_pending[task].size();
+	m_events.reserve(total);
+	for (task = 0; task < m_numTasks; task++) {
+		m_offsets[task] = m_events.size();
+		m_events.insert(m_events.end(), m_pending[task].begin(), m_pending[task].end());
+		vector<packed_event>().swap(m_pending[task]);
+	}
+	m_offsets[m_numTasks] = m_events.size();
+	vector<vector<packed_event> >().swap(m_pending);
+	m_numEvents = m_events.size();
+	m_data = m_events.data();
+	m_offsetsData = m_offsets.data();
+}
+
+/**
+ * Saves the (sealed) program as a binary trace.
+ */
+void traceProgram::writeBinary(const char *filename) const {
+	binary_trace_header header;
+	ofstream file(filename, ios::out | ios::trunc | ios::binary);
+	if (!file) {
+		cerr << "Can't open the binary trace file: " << filename << endl;
+		exit(-1);
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BINARY_TRACE_MAGIC, 8);
+	header.version = BINARY_TRACE_VERSION;
+	header.byteOrder = BINARY_TRACE_BYTE_ORDER;
+	header.eventSize = sizeof(packed_event);
+	header.cutmpi = g_cutmpi;
+	header.collectiveAlgorithm = g_collective_algorithm;
+	header.numTasks = m_numTasks;
+	header.numEvents = m_numEvents;
+	header.packetSize = g_packet_size;
+	header.phitSize = g_phit_size;
+	header.opPerCycle = g_op_per_cycle;
+	header.cpuSpeed = g_cpu_speed;
+	file.write((const char *) &header, sizeof(header));
+	file.write((const char *) m_offsetsData, (m_numTasks + 1) * sizeof(long));
+	if (m_spill != NULL) {
+		/* Copy the chunks of every task from the spill file, in task order */
+		vector<packed_event> chunk;
+		for (int task = 0; task < m_numTasks && file; task++) {
+			for (unsigned int c = 0; c < m_chunks[task].size(); c++) {
+				chunk.resize(m_chunks[task][c].second);
+				if (fseeko(m_spill, m_chunks[task][c].first, SEEK_SET) != 0
+						|| fread(chunk.data(), sizeof(packed_event), chunk.size(), m_spill) != chunk.size()) {
+					cerr << "Error reading the trace spill file: " << m_spillFile << endl;
+					exit(-1);
+				}
+				file.write((const char *) chunk.data(), chunk.size() * sizeof(packed_event));
+			}
+		}
+	} else
+		file.write((const char *) m_data, m_numEvents * sizeof(packed_event));
+	if (!file) {
+		cerr << "Error writing the binary trace file: " << filename << endl;
+		exit(-1);
+	}
+}
+
+/**
+ * Determines whether a trace file is a binary trace, upon its magic number.
+ */
+bool traceProgram::isBinaryFile(const char *filename) {
+	char magic[8];
+	ifstream file(filename, ios::in | ios::binary);
+	if (!file.read(magic, 8)) return false;
+	return strncmp(magic, BINARY_TRACE_MAGIC, 8) == 0;
+}
 
 /**
  * Initializes an event queue.
@@ -28,36 +283,67 @@
  * @param q a pointer to the queue to be initialized.
  */
 void init_event(event_q *q) {
-	q->head = NULL;
-	q->tail = NULL;
+	q->next = NULL;
+	q->end = NULL;
+	q->mark = NULL;
+	q->count = 0;
+	q->trace_id = 0;
+	q->task_id = 0;
+	q->instance = 0;
 }
 
 /**
- * Empties an event queue
- *
- * @param q a pointer to the queue to be initialized.
+ * Points an event queue to the events of a task in a trace program.
  */
-void clear_event(generatorModule **generators_array, int trace_id, vector<int> instances, int task_id) {
-	int iter, source_id;
-	for (iter = 0; iter < int(instances.size()); iter++) {
-		source_id = g_trace_2_gen_map[trace_id][task_id][instances[iter]];
-		g_generators_list[source_id]->resetEventQueue();
+void load_events(event_q *q, const traceProgram *program, int trace_id, int task_id, int instance) {
+	q->next = program->taskBegin(task_id);
+	q->end = program->taskEnd(task_id);
+	q->mark = q->end;
+	q->count = 0;
+	q->trace_id = trace_id;
+	q->task_id = task_id;
+	q->instance = instance;
+	if (trace_id < g_trace_prefetchers.size() && g_trace_prefetchers[trace_id] != NULL) {
+		g_trace_prefetchers[trace_id]->advance(task_id, instance, 0);
+		q->mark = q->next + g_trace_prefetchers[trace_id]->getWindow() / 2;
 	}
 }
 
 /**
- * Adds an event to a queue.
- * 
- * @param q a pointer to a queue.
- * @param i the event to be added to q.
+ * Called when a cursor reaches its mark, in streamed traces: requests the next
+ * window of events, and sets the mark at the half of it.
  */
-void ins_event(generatorModule **generators_array, int trace_id, vector<int> instances, int task_id, event i) {
-	int iter, source_id, dest_id;
-	for (iter = 0; iter < int(instances.size()); iter++) {
-		source_id = g_trace_2_gen_map[trace_id][task_id][instances[iter]];
-		dest_id = g_trace_2_gen_map[trace_id][i.pid][instances[iter]];
-		g_generators_list[source_id]->insertEvent(i, dest_id);
+static void request_window(event_q *q) {
+	if (q->trace_id >= g_trace_prefetchers.size() || g_trace_prefetchers[q->trace_id] == NULL) {
+		q->mark = q->end;
+		return;
 	}
+	tracePrefetcher *prefetcher = g_trace_prefetchers[q->trace_id];
+	prefetcher->advance(q->task_id, q->instance, q->next - g_trace_programs[q->trace_id]->taskBegin(q->task_id));
+	q->mark = q->next + prefetcher->getWindow() / 2;
+}
+
+/**
+ * Moves the cursor of a queue past its first event.
+ */
+static inline void advance_head(event_q *q) {
+	q->next++;
+	q->count = 0;
+	if (q->next >= q->mark && q->next < q->end) request_window(q);
+}
+
+/**
+ * Unpacks the first event in the queue, translating its other node into
+ * the generator that runs that task in the queue's trace instance.
+ */
+static inline void unpack_head(event_q *q, event *i) {
+	const packed_event *p = q->next;
+	i->type = (event_t) p->type;
+	i->pid = traceNodeGenerator(q->trace_id, p->pid, q->instance);
+	i->task = p->task;
+	i->length = p->length;
+	i->count = q->count;
+	i->mpitype = (enum coll_ev_t) p->mpitype;
 }
 
 /**
@@ -70,30 +356,18 @@ void ins_event(generatorModule **generators_array, int trace_id, vector<int> ins
  * @param i A pointer to the event to do.
  */
 void do_event(event_q *q, event *i) {
-	event_n *e;
-	if (q->head == NULL) cout << "Using event from an empty queue" << endl;
-	e = q->head;
-	e->ev.count++;
-	*i = e->ev;
-	if (i->count == i->length) {
-		q->head = q->head->next;
-		delete e;
-		if (q->head == NULL) q->tail = NULL;
-	}
+	if (q->next == q->end) cout << "Using event from an empty queue" << endl;
+	q->count++;
+	unpack_head(q, i);
+	if (i->count == i->length) advance_head(q);
 }
 
 void do_multiple_events(event_q *q, event *i, long counter) {
-	event_n *e;
-	if (q->head == NULL) cout << "Using event from an empty queue" << endl;
-	e = q->head;
-	e->ev.count += counter;
-	assert(e->ev.count <= e->ev.length);
-	*i = e->ev;
-	if (i->count == i->length) {
-		q->head = q->head->next;
-		delete e;
-		if (q->head == NULL) q->tail = NULL;
-	}
+	if (q->next == q->end) cout << "Using event from an empty queue" << endl;
+	q->count += counter;
+	assert(q->count <= q->next->length);
+	unpack_head(q, i);
+	if (i->count == i->length) advance_head(q);
 }
 
 /**
@@ -103,9 +377,11 @@ void do_multiple_events(event_q *q, event *i, long counter) {
  * @return The first event in the queue (without using nor modifying it).
  */
 event head_event(event_q *q) {
-	if (q->head == NULL) cout << "Getting event from an empty queue" << endl;
-	assert(q->head != NULL);
-	return q->head->ev;
+	event e;
+	if (q->next == q->end) cout << "Getting event from an empty queue" << endl;
+	assert(q->next != q->end);
+	unpack_head(q, &e);
+	return e;
 }
 
 /**
@@ -114,10 +390,9 @@ event head_event(event_q *q) {
  * @param q A pointer to the queue.
  */
 void rem_head_event(event_q *q) {
-	if (q->head == NULL) cout << "Deleting event from an empty queue" << endl;
-	assert(q->head != NULL);
-	q->head = q->head->next;
-	if (q->head == NULL) q->tail = NULL;
+	if (q->next == q->end) cout << "Deleting event from an empty queue" << endl;
+	assert(q->next != q->end);
+	advance_head(q);
 }
 
 /**
@@ -127,7 +402,7 @@ void rem_head_event(event_q *q) {
  * @return TRUE if the queue is empty FALSE in other case.
  */
 bool event_empty(event_q *q) {
-	return (q->head == NULL);
+	return (q->next == q->end);
 }
 
 /** 
@@ -138,55 +413,48 @@ bool event_empty(event_q *q) {
  * @param l A pointer to the list to be initialized.
  */
 void init_occur(event_l *l) {
-	(*l).first = NULL;
+	l->pending.clear();
+	l->p2p_done.clear();
+	l->coll_done.clear();
 }
 
 /**
  * Inserts an event's occurrence in an event list.
  *
  * If the event is in the list, then its count is increased. Otherwise a new event is created
- * in the occurred event list.
+ * in the occurred event list. When all packets of the event have arrived, it is accounted as
+ * completed.
  * 
  * @param l A pointer to a list.
  * @param i The event to be added.
  */
 void ins_occur(event_l *l, event i) {
-	event_n *e = (*l).first;
-	event_n *aux = NULL;
-
-	if (e == NULL) { // List is Empty
-		// Create a new occurred event
-		aux = new event_n;
-		i.count = 1;
-		aux->ev = i;
-		aux->next = (*l).first;
-		(*l).first = aux;
-		return;
-	}
+	occur_key key = { i.pid, i.task, i.length };
+	enum coll_ev_t mpitype = i.mpitype;
+	long count = 1;
 
-	if (e->ev.type == i.type && e->ev.pid == i.pid && e->ev.task == i.task && e->ev.length == i.length
-			&& e->ev.count < e->ev.length) {
-		// The occurence is the first element.
-		e->ev.count++;
-		return;
+	assert(i.type == RECEPTION);
+	unordered_map<occur_key, occur_progress, occur_key_hash>::iterator it = l->pending.find(key);
+	if (it != l->pending.end()) {
+		count = ++it->second.count;
+		mpitype = it->second.mpitype;
 	}
-
-	while (e->next != NULL) {
-		if (e->next->ev.type == i.type && e->next->ev.pid == i.pid && e->next->ev.task == i.task
-				&& e->next->ev.length == i.length && e->next->ev.count < e->next->ev.length) {
-			// Another element in the list
-			e->next->ev.count++;
-			return;
+	if (count < i.length) {
+		if (it == l->pending.end()) {
+			occur_progress progress = { count, mpitype };
+			l->pending.insert(make_pair(key, progress));
 		}
-		e = e->next;
+		return;
 	}
 
-	// There is not in the list, so we create a new occurred event
-	aux = new event_n;
-	i.count = 1;
-	aux->ev = i;
-	aux->next = (*l).first;
-	(*l).first = aux;
+	/* Message completed */
+	if (it != l->pending.end()) l->pending.erase(it);
+	if (mpitype > 0) {
+		occur_key coll_key = { mpitype, i.task, i.length };
+		l->coll_done[coll_key]++;
+	} else {
+		l->p2p_done[key]++;
+	}
 }
 
 /**
@@ -200,28 +468,21 @@ void ins_occur(event_l *l, event i) {
  * @return TRUE if the event has been occurred, elseway FALSE
  */
 bool occurred(event_l *l, event i) {
-	event_n *e = (*l).first;
-	event_n *aux;
-
-	if (e == NULL) // List is Empty
-		return false;
-	if (e->ev.type == i.type && e->ev.count == e->ev.length && e->ev.task == i.task && e->ev.length == i.length
-			&& e->ev.mpitype == i.mpitype && (i.mpitype > 0 || (e->ev.pid == i.pid))) {
-		aux = e->next;
-		delete e;
-		(*l).first = aux;
-		return true;
-	}
-
-	while (e->next != NULL) {
-		if (e->next->ev.type == i.type && e->next->ev.count == e->next->ev.length && e->next->ev.task == i.task
-				&& e->next->ev.length == i.length && e->next->ev.mpitype == i.mpitype
-				&& (i.mpitype > 0 || (e->next->ev.pid == i.pid))) {
-			aux = e->next->next;
-			e->next = aux;
-			return true;
-		}
-		e = e->next;
-	}
-	return false;
+	unordered_map<occur_key, long, occur_key_hash> &done = (i.mpitype > 0) ? l->coll_done : l->p2p_done;
+	occur_key key = { (i.mpitype > 0) ? (long) i.mpitype : i.pid, i.task, i.length };
+
+	assert(i.type == RECEPTION);
+	unordered_map<occur_key, long, occur_key_hash>::iterator it = done.find(key);
+	if (it == done.end()) return false;
+	if (--it->second == 0) done.erase(it);
+	return true;
+}
+
+/**
+ * Has an event completely occurred? (without removing it from the list).
+ */
+bool has_occurred(event_l *l, event i) {
+	unordered_map<occur_key, long, occur_key_hash> &done = (i.mpitype > 0) ? l->coll_done : l->p2p_done;
+	occur_key key = { (i.mpitype > 0) ? (long) i.mpitype : i.pid, i.task, i.length };
+	return done.find(key) != done.end();
 }
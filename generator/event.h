@@ -23,6 +23,9 @@
 #define _event
 
 #include <iostream>
+#include <cstdio>
+#include <sys/types.h>
+#include <unordered_map>
 #include "../global.h"
 #include "dimemas.h"
 
@@ -54,46 +57,154 @@ typedef struct event {
 } event;
 
 /**
- * Structure that defines a node for event queue & lists.
- * @see event_q
- * @see event_l
+ * Compact representation of a trace event, as stored in a compiled trace program.
+ *
+ * The other node is kept as a trace task id; it is translated into a generator id
+ * when the event reaches the head of a generator queue, so the same program can be
+ * replayed by every instance of the trace.
  */
-typedef struct event_n {
-	event ev;				///< The event in this position.
-	struct event_n * next;	///< The next node in the list/queue.
-} event_n;
+typedef struct packed_event {
+	long length;			///< Length of the message in packets. Number of cycles in computation.
+	int pid;				///< The other task (trace node id).
+	int task;				///< An id for distinguish messages.
+	unsigned char type;		///< Type of the event (event_t).
+	unsigned char mpitype;	///< MPI Collective Event Type (coll_ev_t).
+} packed_event;
+
+/**
+ * Immutable per-task event streams of a trace.
+ *
+ * The trace file is parsed once into per-task event lists, which are then sealed
+ * into a single flat array indexed by task. Generators replay their task stream
+ * through a cursor, so (re)loading a trace instance does not copy any event.
+ *
+ * A sealed program can be saved as a binary trace (see writeBinary()), which is
+ * later mapped into memory as is, with no parsing at all. When converting traces
+ * larger than memory, the program can be built upon a spill file instead: parsed
+ * events are flushed to it in per-task chunks once 'spillBudget' of them are held,
+ * and they are only copied in task order when writing the binary trace. Such a
+ * program can not be replayed.
+ */
+class traceProgram {
+public:
+	traceProgram(int numTasks, const char *spillFile = NULL, long spillBudget = 0);
+	traceProgram(const char *binaryFile);
+	~traceProgram();
+	void addEvent(int task, const event& ev);
+	void clearTask(int task);
+	void seal();
+	void writeBinary(const char *filename) const;
+	static bool isBinaryFile(const char *filename);
+	inline int getNumTasks() const {
+		return m_numTasks;
+	}
+	inline long getNumEvents() const {
+		return m_numEvents;
+	}
+	inline bool isMapped() const {
+		return m_map != NULL;
+	}
+	inline bool isSpilled() const {
+		return m_spill != NULL;
+	}
+	inline const packed_event * taskBegin(int task) const {
+		assert(task >= 0 && task < m_numTasks);
+		return m_data + m_offsetsData[task];
+	}
+	inline const packed_event * taskEnd(int task) const {
+		assert(task >= 0 && task < m_numTasks);
+		return m_data + m_offsetsData[task + 1];
+	}
+private:
+	int m_numTasks;
+	long m_numEvents;
+	vector<vector<packed_event> > m_pending; /* Per-task lists, only while parsing */
+	vector<packed_event> m_events;
+	vector<long> m_offsets;
+	const packed_event *m_data; /* Either m_events or the mapped file contents */
+	const long *m_offsetsData;
+	void *m_map;
+	size_t m_mapLength;
+	FILE *m_spill; /* Spill file of a streamed conversion (NULL if events are kept in memory) */
+	string m_spillFile;
+	long m_spillBudget, m_pendingEvents;
+	vector<vector<pair<off_t, long> > > m_chunks; /* Per-task (offset, events) chunks in the spill file */
+	void spill();
+};
 
 /**
  * Structure that defines an event queue.
+ *
+ * It is a cursor over the events of a task in a compiled trace program; only the
+ * progress of the head event is kept per generator.
  */
 typedef struct event_q {
-	event_n *head;	///< A pointer to the first event node (for removing).
-	event_n *tail;	///< A pointer to the last event node (for enqueuing).
+	const packed_event *next;	///< The first pending event.
+	const packed_event *end;	///< One past the last event of the task.
+	const packed_event *mark;	///< Position at which the next window is requested (streamed traces).
+	long count;					///< Packets sent/arrived (elapsed cycles) of the first event.
+	int trace_id;				///< Trace the events belong to.
+	int task_id;				///< Task whose events are replayed.
+	int instance;				///< Trace instance, to translate task ids into generators.
 } event_q;
 
 /**
- * Structure that defines a list of events.
+ * Key of an occurred reception: (peer, task, length) for messages, and
+ * (collective type, task, length) for completed collective receptions.
  */
-typedef struct event_l {
-	event_n * first;	///< A pointer to the first element of the list.
-} event_l;
+typedef struct occur_key {
+	long peer;		///< Source node (or collective type).
+	long task;		///< Message tag.
+	long length;	///< Length in packets.
+	bool operator==(const occur_key& other) const {
+		return peer == other.peer && task == other.task && length == other.length;
+	}
+} occur_key;
 
-void init_event(event_q *q);
+struct occur_key_hash {
+	size_t operator()(const occur_key& k) const {
+		size_t h = hash<long>()(k.peer);
+		h ^= hash<long>()(k.task) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+		h ^= hash<long>()(k.length) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+		return h;
+	}
+};
 
 /**
- * Empties an event queue
+ * Received packets of a message still in progress.
+ */
+typedef struct occur_progress {
+	long count;				///< Packets arrived.
+	enum coll_ev_t mpitype;	///< MPI Collective Event Type of the first packet.
+} occur_progress;
+
+/**
+ * Structure that defines the occurred (received) events of a node.
  *
- * @param q a pointer to the queue to be initialized.
+ * At most one message per (peer, task, length) can be in progress at a time,
+ * since packets are always accounted to the pending one; once all its packets
+ * have arrived, only the number of completed messages has to be kept, indexed
+ * as reception events look for them (by peer for point-to-point messages, and
+ * by collective type otherwise). Insertion and completion tests are O(1).
  */
-void clear_event(generatorModule **generators_array, int trace_id, vector<int> instances, int task_id);
+typedef struct event_l {
+	unordered_map<occur_key, occur_progress, occur_key_hash> pending;	///< Messages in progress.
+	unordered_map<occur_key, long, occur_key_hash> p2p_done;		///< Completed messages, by peer.
+	unordered_map<occur_key, long, occur_key_hash> coll_done;		///< Completed collective messages, by type.
+} event_l;
+
+void init_event(event_q *q);
 
 /**
- * Adds an event to a queue.
+ * Points an event queue to the events of a task in a trace program.
  *
- * @param q a pointer to a queue.
- * @param i the event to be added to q.
+ * @param q a pointer to the queue.
+ * @param program the compiled trace.
+ * @param trace_id the trace id.
+ * @param task_id the task (trace node) whose events are replayed.
+ * @param instance the trace instance the queue belongs to.
  */
-void ins_event(generatorModule **generators_array, int trace_id, vector<int> instances, int task_id, event i);
+void load_events(event_q *q, const traceProgram *program, int trace_id, int task_id, int instance);
 
 /**
  * Uses the first event in the queue.
@@ -146,5 +257,7 @@ void ins_occur(event_l *l, event i);
 
 bool occurred(event_l *l, event i);
 
+bool has_occurred(event_l *l, event i);
+
 #endif /* _event */
 
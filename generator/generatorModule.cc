@@ -21,6 +21,10 @@
 #include "generatorModule.h"
 #include <math.h>
 #include <string.h>
+#include "../histogram.h"
+#include "../packetTracer.h"
+#include "../checkpoint.h"
+#include "../batchMeans.h"
 
 using namespace std;
 
@@ -43,22 +47,23 @@ generatorModule::generatorModule(int interArrivalTime, string name, int sourceLa
 	injection_probability = g_injection_probability;
 	sum_injection_probability = 0;
 	pendingPetitions = 0;
+	seedTraffic();
 
 	switch (g_traffic) {
 		case SINGLE_BURST:
-			this->pattern = new burstTraffic(this->sourceLabel, this->pPos, this->aPos, this->hPos);
+			this->pattern = new burstTraffic(this, this->sourceLabel, this->pPos, this->aPos, this->hPos);
 			break;
 		case ALL2ALL:
-			this->pattern = new all2allTraffic(this->sourceLabel, this->pPos, this->aPos, this->hPos);
+			this->pattern = new all2allTraffic(this, this->sourceLabel, this->pPos, this->aPos, this->hPos);
 			break;
 		case MIX:
-			this->pattern = new mixTraffic(this->sourceLabel, this->pPos, this->aPos, this->hPos);
+			this->pattern = new mixTraffic(this, this->sourceLabel, this->pPos, this->aPos, this->hPos);
 			break;
 		case TRANSIENT:
-			this->pattern = new transientTraffic(this->sourceLabel, this->pPos, this->aPos, this->hPos);
+			this->pattern = new transientTraffic(this, this->sourceLabel, this->pPos, this->aPos, this->hPos);
 			break;
 		default:
-			this->pattern = new steadyTraffic(this->sourceLabel, this->pPos, this->aPos, this->hPos);
+			this->pattern = new steadyTraffic(this, this->sourceLabel, this->pPos, this->aPos, this->hPos);
 	}
 
 	flit = NULL;
@@ -198,7 +203,7 @@ flitModule* generatorModule::generateFlit(FlitType flitType, int destId) {
 		if ((m_flitSeq > 0) || (g_cycle == 0) || ((g_cycle >= (lastTimeSent + interArrivalTime)))) {
 			if ((m_flitSeq > 0)
 					|| (switchM->switchModule::getPortCredits(this->pPos, 0, vct) >= g_packet_size
-							&& rand() / ((double) RAND_MAX + 1)
+							&& trafficRand() / ((double) RAND_MAX + 1)
 									< ((double) injection_probability / 100.0) / (1.0 * g_packet_size)
 							&& (flitType == RESPONSE || g_max_petitions_on_flight < 0
 									|| pendingPetitions < g_max_petitions_on_flight))) {
@@ -433,6 +438,8 @@ void generatorModule::consumeFlit(flitModule *flit, int input_port, int input_ch
 		if (g_congestion_management != QCNSW)
 			assert(false); /* CNM message type not exists without QCNSW congestion management mechanisms */
 	}
+	if (g_packet_trace)
+		g_packet_tracer->record(PKT_CONSUME, this->switchM->label, flit, input_port, input_channel, pPos, -1);
 	trackConsumptionStatistics(flit, input_port, input_channel, pPos);
 	delete flit;
 }
@@ -535,25 +542,14 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 		}
 		if (flit->getMisrouted()) g_nonminimal_counter++;
 		if (flit->head == 1) {
-			/* If new latency value exceeds current max histogram value,
-			 * enlarge vectors to fit new values. */
-			if (flitLatency >= g_latency_histogram_maxLat) {
-				g_latency_histogram_no_global_misroute.insert(g_latency_histogram_no_global_misroute.end(),
-						flitLatency + 1 - g_latency_histogram_maxLat, 0);
-				g_latency_histogram_global_misroute_at_injection.insert(
-						g_latency_histogram_global_misroute_at_injection.end(),
-						flitLatency + 1 - g_latency_histogram_maxLat, 0);
-				g_latency_histogram_other_global_misroute.insert(g_latency_histogram_other_global_misroute.end(),
-						flitLatency + 1 - g_latency_histogram_maxLat, 0);
-				g_latency_histogram_maxLat = flitLatency + 1;
-				assert(g_latency_histogram_no_global_misroute.size() == g_latency_histogram_maxLat);
-				assert(g_latency_histogram_global_misroute_at_injection.size() == g_latency_histogram_maxLat);
-				assert(g_latency_histogram_other_global_misroute.size() == g_latency_histogram_maxLat);
-			}
+			/* Histograms have a fixed footprint; just track max latency value
+			 * to bound the histogram output. */
+			if (flitLatency >= g_latency_histogram_maxLat) g_latency_histogram_maxLat = flitLatency + 1;
+			g_injection_latency_histogram->record(flit->injLatency);
 
 			if (not (g_routing == PAR || g_routing == RLM || g_routing == OLM)) {
 				/* If NOT using vc misrouting, store all latency values in a single histogram. */
-				g_latency_histogram_other_global_misroute[int(flitLatency)]++;
+				g_latency_histogram_other_global_misroute->record(flitLatency);
 			} /* Otherwise, split into three: */
 			else if (flit->globalHopCount <= 1) {
 				//1- NO GLOBAL MISROUTE
@@ -562,7 +558,7 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 				assert(flit->globalHopCount <= 1);
 				assert(flit->getMisrouteCount(GLOBAL) == 0);
 				assert(flit->getMisrouteCount(GLOBAL_MANDATORY) == 0);
-				g_latency_histogram_no_global_misroute[int(flitLatency)]++;
+				g_latency_histogram_no_global_misroute->record(flitLatency);
 			} else if (flit->isGlobalMisrouteAtInjection()) {
 				//2- GLOBAL MISROUTING AT INJECTION
 				assert(flit->getMisrouteCount(NONE) >= 1 && flit->getMisrouteCount(NONE) <= 3);
@@ -571,7 +567,7 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 				assert(flit->localHopCount <= 4);
 				assert(flit->globalHopCount == 2);
 				assert(flit->getMisrouteCount(GLOBAL_MANDATORY) == 0);
-				g_latency_histogram_global_misroute_at_injection[int(flitLatency)]++;
+				g_latency_histogram_global_misroute_at_injection->record(flitLatency);
 			} else {
 				//3- OTHER GLOBAL MISROUTE (after local hop in source group)
 				assert(flit->getMisrouteCount(NONE) >= 1 && flit->getMisrouteCount(NONE) <= 4);
@@ -579,13 +575,13 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 				assert(flit->hopCount <= 8);
 				assert(flit->localHopCount <= 6);
 				assert(flit->globalHopCount == 2);
-				g_latency_histogram_other_global_misroute[int(flitLatency)]++;
+				g_latency_histogram_other_global_misroute->record(flitLatency);
 			}
 		}
 	}
 
-	if ((g_internal_cycle >= g_warmup_cycles) && (flit->hopCount < g_hops_histogram_maxHops) && (flit->head == 1)) {
-		g_hops_histogram[flit->hopCount]++;
+	if ((g_internal_cycle >= g_warmup_cycles) && (flit->head == 1)) {
+		g_hops_histogram->record(flit->hopCount);
 	}
 
 	/* Group 0, per switch averaged latency */
@@ -618,6 +614,8 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 	assert(flit->injLatency >= 0);
 	g_injection_queue_latency += flit->injLatency;
 	assert(g_injection_queue_latency >= 0);
+	if (g_batch_means != NULL && g_internal_cycle >= g_warmup_cycles)
+		g_batch_means->record(flitLatency, flit->tail == 1, packetLatency);
 
 	//Transient traffic recording
 	if (g_transient_stats) {
@@ -684,3 +682,38 @@ void generatorModule::trackConsumptionStatistics(flitModule *flit, int inP, int
 
 	this->switchM->increasePortCount(outP);
 }
+
+/*
+ * Seeds the traffic stream of this generator upon the simulation seed, so
+ * its arrivals do not depend on the random draws of the rest of modules.
+ */
+void generatorModule::seedTraffic() {
+	seed_seq seed { (unsigned int) g_seed, (unsigned int) sourceLabel };
+	m_trafficRng.seed(seed);
+}
+
+/*
+ * Stores (or restores) the generator state. Injection probability is
+ * left out, so that runs restored from a checkpoint may employ a
+ * different one; the flit pointer only refers to already injected
+ * flits, which are stored along with the switch buffers.
+ */
+void generatorModule::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(lastTimeSent);
+	ckpt.value(m_valiantLabel);
+	ckpt.value(m_assignedRing);
+	ckpt.value(m_min_path);
+	ckpt.value(m_val_path);
+	ckpt.value(m_injVC);
+	ckpt.value(m_flitSeq);
+	ckpt.value(destLabel);
+	ckpt.value(destSwitch);
+	ckpt.value(m_packet_id);
+	ckpt.value(m_packet_in_cycle);
+	ckpt.value(pendingPetitions);
+	ckpt.value(lastConsumeCycle);
+	ckpt.value(sum_injection_probability);
+	ckpt.value(pattern->rpDestination);
+	ckpt.value(m_trafficRng);
+	if (ckpt.isRestoring()) flit = NULL;
+}
@@ -55,6 +55,7 @@ protected:
 	vector<int> injPetVcs, injResVcs;
 	float injection_probability;
 	int pendingPetitions;
+	minstd_rand m_trafficRng; /* Stream of the traffic process, in use with common random numbers */
 	void inject();
 public:
 	switchModule *switchM;
@@ -71,11 +72,17 @@ public:
 	void getNodeCoords(int nodeId, int &nodeP, int &nodeA, int &nodeH);
 	int getInjectionVC(int dest, FlitType flitType);
 	vector<int> getArrayInjVC(int dest, bool response);
-	void setInjectionProbability(float newInjectionProbability);
+	virtual void setInjectionProbability(float newInjectionProbability);
 	void decreasePendingPetitions(int numPetitions = 1);
 	virtual bool checkConsume(flitModule *flit);
 	virtual void consumeFlit(flitModule *flit, int input_port, int input_channel);
 	void trackConsumptionStatistics(flitModule *flit, int inP, int inC, int outP);
+	virtual void checkpoint(checkpointFile &ckpt);
+	/* Draws of the traffic process (arrivals and destinations) */
+	inline int trafficRand() {
+		return g_common_random_numbers ? m_trafficRng() : rand();
+	}
+	void seedTraffic();
 	/* Support functions, only intended for trace generator compatibility */
 	virtual inline bool isGenerationEnded() {
 		assert(0);
@@ -83,16 +90,10 @@ public:
 	virtual inline void printHeadEvent() {
 		assert(0);
 	}
-	virtual inline int numSkipCycles() {
-		assert(0);
-	}
 	virtual inline void consumeCycles(int numCycles) {
 		assert(0);
 	}
-	virtual inline void resetEventQueue() {
-		assert(0);
-	}
-	virtual inline void insertEvent(event i, int destId) {
+	virtual inline void loadEvents(const traceProgram *program, int traceId, int taskId, int instance) {
 		assert(0);
 	}
 	virtual inline void insertOccurredEvent(flitModule *flit) {
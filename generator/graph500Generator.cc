@@ -29,15 +29,10 @@ graph500Generator::graph500Generator(int interArrivalTime, string name, int sour
 	/* Assign to each generator its associated process from the benchmark.
 	 * Some nodes won't have any associated process and will stay idle
 	 * during the whole simulation. */
-	if (g_gen_2_trace_map.count(sourceLabel) == 0)
+	if (g_gen_2_trace_map[sourceLabel].trace_id == -1)
 		this->instance = -1;
 	else {
-		TraceNodeId trace_node = g_gen_2_trace_map[sourceLabel];
-		for (int inst = 0; inst < g_trace_instances[0]; inst++)
-			if (g_trace_2_gen_map[0][trace_node.trace_node][inst] == sourceLabel) {
-				this->instance = inst;
-				break;
-			}
+		this->instance = g_gen_2_trace_map[sourceLabel].instance;
 		/* At level 0, only process hosting root vertex send messages */
 		this->state = GraphCNState::COMPUTERECEPTION;
 		if (sourceLabel == g_graph_root_node[this->instance]) // Root node starts in ROOTNODE state (mProc = root_degree))
@@ -331,7 +326,7 @@ void graph500Generator::levelstart() {
 	assert(p2pmessagesToSend * g_graph_coalescing_size >= queriesToSend);
 	assert(p2pmessagesToSend >= 0);
 	// TODO: fix with static variables (A, B, ...) shared by all instances and function to calculate them only once
-	if (sourceLabel == g_trace_2_gen_map[0][g_trace_nodes[0] - 1][instance]) g_graph_queries_rem_minus_means[instance] -= mean;
+	if (sourceLabel == traceNodeGenerator(0, g_trace_nodes[0] - 1, instance)) g_graph_queries_rem_minus_means[instance] -= mean;
 }
 
 void graph500Generator::computegeneration() {
@@ -389,10 +384,10 @@ void graph500Generator::computep2psignal() {
 	assert(flit == NULL);
 	assert(p2pmessagesToSend == 0);
 
-	if (g_trace_2_gen_map[0][endSignalSentCounter][instance] == sourceLabel) endSignalSentCounter++;
+	if (traceNodeGenerator(0, endSignalSentCounter, instance) == sourceLabel) endSignalSentCounter++;
 	/* If skipped sender is last node in the network, don't try to
 	 * send a signal to the next (there's none). */
-	if (endSignalSentCounter < g_trace_nodes[0]) flit = generateFlit(SIGNAL, g_trace_2_gen_map[0][endSignalSentCounter][instance]);
+	if (endSignalSentCounter < g_trace_nodes[0]) flit = generateFlit(SIGNAL, traceNodeGenerator(0, endSignalSentCounter, instance));
 }
 
 void graph500Generator::sendp2psignal() {
@@ -400,7 +395,7 @@ void graph500Generator::sendp2psignal() {
 	assert(endSignalSentCounter < g_trace_nodes[0]);
 	assert(flit != NULL);
 
-	assert(flit->destId == g_trace_2_gen_map[0][endSignalSentCounter][instance]);
+	assert(flit->destId == traceNodeGenerator(0, endSignalSentCounter, instance));
 	switchM->routing->setValNode(flit);
 	this->determinePaths(flit);
 	if (switchM->switchModule::getCredits(this->pPos, 0, flit->channel) >= g_flit_size) {
@@ -449,14 +444,14 @@ void graph500Generator::allreducebroadcast() {
 	assert(allreduceRxCounter < g_trace_nodes[0]);
 
 	if (flit == NULL) {
-		if (g_trace_2_gen_map[0][allreduceRxCounter][instance] != sourceLabel)
-			flit = generateFlit(ALLREDUCE, g_trace_2_gen_map[0][allreduceRxCounter][instance]);
+		if (traceNodeGenerator(0, allreduceRxCounter, instance) != sourceLabel)
+			flit = generateFlit(ALLREDUCE, traceNodeGenerator(0, allreduceRxCounter, instance));
 		else
 			allreduceRxCounter++;
 	}
 
 	if (flit != NULL) {
-		assert(flit->destId == g_trace_2_gen_map[0][allreduceRxCounter][instance]);
+		assert(flit->destId == traceNodeGenerator(0, allreduceRxCounter, instance));
 		switchM->routing->setValNode(flit);
 		this->determinePaths(flit);
 		if (switchM->switchModule::getCredits(this->pPos, 0, flit->channel) >= g_flit_size) {
@@ -36,6 +36,9 @@
 #include "trace.h"
 #include "event.h"
 #include "generatorModule.h"
+#include "tracePrefetcher.h"
+#include "traceReader.h"
+#include "collectiveCache.h"
 #include "../communicator.h"
 
 typedef struct {
@@ -52,26 +55,85 @@ typedef struct {
  * 'c', 's' or 'r' for fsin trc, and '-' for alog (in complete trace the header is "-1",
  * or in filtered trace could be "-101" / "-102"). This is a very naive decision, so we
  * probably have to change this, but for the moment it works.
+ *
+ * The trace file is only parsed the first time it is read, into a compiled program
+ * (see traceProgram) that is kept in g_trace_programs. Loading (or reloading, once
+ * finished) a trace instance just points its generators to their task streams.
  * 
+ *@see compile_trace
  *@see read_dimemas
  *@see read_fsin_trc
  *@see read_alog
  */
 void read_trace(int trace_id, vector<int> instances) {
-	FILE * ftrc;
-	char c;
+	traceProgram *program;
 	cout << ">>read_trace: " << g_trace_file[trace_id] << endl;
 
-	if ((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) == NULL) {
-		cout << "Trace file not found in current directory" << endl;
+	if (g_trace_programs.size() <= trace_id) g_trace_programs.resize(trace_id + 1, NULL);
+	if (g_trace_programs[trace_id] == NULL) {
+		g_trace_programs[trace_id] = compile_trace(trace_id);
+		/* Binary traces can be streamed through a bounded window per task */
+		if (g_trace_window > 0) {
+			if (g_trace_prefetchers.size() <= trace_id) g_trace_prefetchers.resize(trace_id + 1, NULL);
+			if (g_trace_programs[trace_id]->isMapped())
+				g_trace_prefetchers[trace_id] = new tracePrefetcher(g_trace_programs[trace_id],
+						g_trace_instances[trace_id], g_trace_window);
+			else
+				cout << "TraceWindow only applies to binary traces; " << g_trace_file[trace_id]
+						<< " is kept in memory" << endl;
+		}
+	}
+	program = g_trace_programs[trace_id];
+
+	for (int j = 0; j < instances.size(); j++) {
+		bool trace_empty = true;
+		for (int k = 0; k < g_trace_nodes[trace_id]; k++) {
+			int gen = traceNodeGenerator(trace_id, k, instances[j]);
+			assert(gen < g_number_generators); // Sanity check
+			g_generators_list[gen]->loadEvents(program, trace_id, k, instances[j]);
+			if (!g_generators_list[gen]->isGenerationEnded()) trace_empty = false;
+		}
+		if (trace_empty && program->getNumEvents() > 0)
+			cerr << "Error when loading trace " << trace_id << ", instance " << instances[j]
+					<< ": event queues are empty!" << endl;
+		assert(!trace_empty || program->getNumEvents() == 0); // Sanity check, to ensure trace instance has been properly loaded
+		if (trace_empty) g_trace_drained.push_back(make_pair(trace_id, instances[j]));
+	}
+	cout << "<<read_trace" << endl;
+}
+
+/**
+ * Builds the event program of a trace. Binary traces (as generated by the
+ * fogsim-trace converter) are mapped into memory; text traces are parsed,
+ * translating their event types upon the PCF file. If a spill file is given,
+ * parsed events are streamed into it (see traceProgram), so the program can
+ * only be saved as a binary trace.
+ */
+traceProgram * compile_trace(int trace_id, const char *spill_file, long spill_budget) {
+	traceReader *ftrc;
+	char c, first[2];
+	traceProgram *program;
+
+	if (traceProgram::isBinaryFile(g_trace_file[trace_id].c_str())) {
+		program = new traceProgram(g_trace_file[trace_id].c_str());
+		if (program->getNumTasks() != g_trace_nodes[trace_id]) {
+			cerr << "Number of nodes in binary trace (" << program->getNumTasks()
+					<< ") doesn't match spec in config file!!" << endl;
+			exit(-1);
+		}
+		return program;
 	}
-	assert((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) != NULL);
-	c = (char) fgetc(ftrc);
-	fclose(ftrc);
+
+	program = new traceProgram(g_trace_nodes[trace_id], spill_file, spill_budget);
+	/* Text traces may be compressed; sniff their first (decompressed) byte */
+	ftrc = new traceReader(g_trace_file[trace_id].c_str());
+	c = (ftrc->getLine(first, 2) == NULL) ? -1 : first[0];
+	delete ftrc;
 
 	switch (c) {
 		case '#':
-			read_dimemas(trace_id, instances);
+			translate_pcf_file(trace_id);
+			read_dimemas(trace_id, program);
 			break;
 		case -1:
 			cout << "Reading empty file\n" << endl;
@@ -80,7 +142,8 @@ void read_trace(int trace_id, vector<int> instances) {
 			cout << "Cannot understand this trace format" << endl;
 			break;
 	}
-	cout << "<<read_trace" << endl;
+	program->seal();
+	return program;
 }
 
 /**
@@ -88,10 +151,11 @@ void read_trace(int trace_id, vector<int> instances) {
  *
  * Read a trace from a dimemas file whose name is in global variable #g_trace_file
  * It only consideres events for CPU and point to point operations. File I/O could be
- * considered as a cpu event if FILEIO is defined.
+ * considered as a cpu event if FILEIO is defined. Events are compiled into the
+ * per-task streams of the given program.
  */
-void read_dimemas(int trace_id, vector<int> instances) {
-	FILE * ftrc;
+void read_dimemas(int trace_id, traceProgram *program) {
+	traceReader *ftrc;
 	char buffer[BUFSIZE];
 	long n; ///< The number of nodes is read here.
 	char sep[] = ":"; ///< Dimemas record separator.
@@ -119,19 +183,18 @@ void read_dimemas(int trace_id, vector<int> instances) {
 	long root;
 	enum coll_ev_t mpi_task = (enum coll_ev_t) -1;
 	long mpi_type = -1, mpi_sendsize = -1, mpi_recvsize = -1, mpi_communicator = -1, mpi_isroot = 0;
-	const long mpilist_allocated = 65536;
 
 	mpi_collective_comm_t mpilist_aux;
 	map<long, vector<mpi_collective_comm_t> > mpilist_map; // Each communicator has it list of collectives
 	map<long, long> mpilist_comm_to_offset;
 	map<long, communicator*> communicator_map;
+	map<long, vector<long> > communicator_ranks; // Rank of every task within each communicator (-1 if none)
+	collectiveCache collectives(g_collective_algorithm);
 
 	cout << ">>read_dimemas" << endl;
 
-	if ((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) == NULL)
-		cout << "Trace file not found in current directory" << endl;
-	assert((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) != NULL);
-	while (fgets(buffer, BUFSIZE, ftrc) != NULL) {
+	ftrc = new traceReader(g_trace_file[trace_id].c_str());
+	while (ftrc->getLine(buffer, BUFSIZE) != NULL) {
 		op_id = strtok(buffer, sep);
 
 		if (!strcmp(op_id, "#DIMEMAS")) {
@@ -222,28 +285,14 @@ void read_dimemas(int trace_id, vector<int> instances) {
 #if DEBUG
 					cout << "communicator_id count:" << mpilist_map.count(comm_id) << endl;
 #endif
-					//Check if the coll. array for the current communicator exists and if not, create it with -1 values
-					if (mpilist_map.count(comm_id) <= 0) {
-#if DEBUG
-						cout << "communicator_id count:" << mpilist_map.count(comm_id) << endl;
-#endif
-						mpilist_map[comm_id].resize(mpilist_allocated);
-						for (x = 0; x < mpilist_allocated; x++) {
-							(mpilist_map[comm_id])[x].root = -1;
-							(mpilist_map[comm_id])[x].type = -1;
-						}
-					}
-
-					if (mpilist_map[comm_id][mpilist_comm_to_offset[comm_id]].type == -1) {
-						mpilist_map[comm_id][mpilist_comm_to_offset[comm_id]].collective_comm_id =
-								mpilist_comm_to_offset[comm_id];
-						mpilist_map[comm_id][mpilist_comm_to_offset[comm_id]].root = mpilist_aux.root;
-						mpilist_map[comm_id][mpilist_comm_to_offset[comm_id]].type = mpilist_aux.type;
+					//The coll. list of the current communicator grows as new collectives are found
+					vector<mpi_collective_comm_t> &mpilist = mpilist_map[comm_id];
+					if (mpilist_comm_to_offset[comm_id] >= mpilist.size()) {
+						assert(mpilist_comm_to_offset[comm_id] == mpilist.size());
+						mpilist_aux.collective_comm_id = mpilist_comm_to_offset[comm_id];
+						mpilist.push_back(mpilist_aux);
 						mpilist_aux.type = -1; //For the next iter, to find it available
 						mpilist_comm_to_offset[comm_id]++; //This comm offset needs to be increased.
-
-						if (mpilist_comm_to_offset[comm_id] >= mpilist_allocated) cerr << "MPI overflow!" << endl;
-						assert(mpilist_comm_to_offset[comm_id] < mpilist_allocated);
 					}
 
 				} else {
@@ -263,17 +312,15 @@ void read_dimemas(int trace_id, vector<int> instances) {
 				break;
 		}
 	}
-	fclose(ftrc);
+	delete ftrc;
 
 	mpilist_comm_to_offset.clear();
 	mpi_task = (enum coll_ev_t) -1;
 
 	//Normal pass
-	if ((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) == NULL)
-		cerr << "Trace file not found in current directory" << endl;
-	assert((ftrc = fopen(g_trace_file[trace_id].c_str(), "r")) != NULL);
+	ftrc = new traceReader(g_trace_file[trace_id].c_str());
 
-	if (fgets(buffer, BUFSIZE, ftrc) == NULL) cerr << "Error accessing trace file" << endl;
+	if (ftrc->getLine(buffer, BUFSIZE) == NULL) cerr << "Error accessing trace file" << endl;
 	if (strncmp("#DIMEMAS", buffer, 8)) cerr << "Header line is missing, maybe not a dimemas file" << endl;
 	assert(!strncmp("#DIMEMAS", buffer, 8));
 
@@ -289,7 +336,7 @@ void read_dimemas(int trace_id, vector<int> instances) {
 
 	bool tracestop[n]; //Used if g_cutmpi to stop at MPI_Finalize (indexed by task_id)
 	memset(tracestop, 0, sizeof(tracestop)); //Default to false
-	while (fgets(buffer, BUFSIZE, ftrc) != NULL) {
+	while (ftrc->getLine(buffer, BUFSIZE) != NULL) {
 		op_id = strtok(buffer, sep);
 		if (!strcmp(op_id, "s")) // Offset
 			// As we parse the whole file, it is not important for us.
@@ -328,7 +375,7 @@ void read_dimemas(int trace_id, vector<int> instances) {
 				ev.mpitype = (enum coll_ev_t) 0;
 				if (task_id < g_trace_nodes[trace_id] && task_id >= 0) {
 					ev.pid = task_id;
-					ins_event(g_generators_list, trace_id, instances, task_id, ev);
+					program->addEvent(task_id, ev);
 				} else {
 					cerr << "Adding cpu event into a non defined CPU. Task_id = " << task_id << endl;
 					assert(0);
@@ -360,7 +407,7 @@ void read_dimemas(int trace_id, vector<int> instances) {
 							if (task_id < g_trace_nodes[trace_id] && t_id < g_trace_nodes[trace_id] && task_id >= 0
 									&& t_id >= 0) {
 								ev.pid = t_id;
-								ins_event(g_generators_list, trace_id, instances, task_id, ev);
+								program->addEvent(task_id, ev);
 							} else {
 								cerr << "Adding comm event into a non defined CPU" << endl;
 								assert(0);
@@ -400,7 +447,7 @@ void read_dimemas(int trace_id, vector<int> instances) {
 							if (task_id < g_trace_nodes[trace_id] && t_id < g_trace_nodes[trace_id] && task_id >= 0
 									&& t_id >= 0) {
 								ev.pid = t_id;
-								ins_event(g_generators_list, trace_id, instances, task_id, ev);
+								program->addEvent(task_id, ev);
 							} else {
 								cerr << "Adding comm event into a non defined CPU" << endl;
 								assert(0);
@@ -533,6 +580,12 @@ void read_dimemas(int trace_id, vector<int> instances) {
 								<< mpilist_map[mpi_communicator][mpilist_comm_to_offset[mpi_communicator]].type
 								<< endl;
 #endif
+								if (mpilist_comm_to_offset[mpi_communicator] >= mpilist_map[mpi_communicator].size()) {
+									cout << "mpilist[" << mpilist_comm_to_offset[mpi_communicator]
+											<< "] is beyond the collectives found for communicator "
+											<< mpi_communicator << endl;
+									assert(0);
+								}
 								if (mpilist_map[mpi_communicator][mpilist_comm_to_offset[mpi_communicator]].type
 										!= mpi_type) {
 									cout << "mpilist[" << mpilist_comm_to_offset[mpi_communicator] << " ]="
@@ -550,90 +603,57 @@ void read_dimemas(int trace_id, vector<int> instances) {
 										mpilist_map[mpi_communicator][mpilist_comm_to_offset[mpi_communicator]].type
 												== mpi_type);
 								root = mpilist_map[mpi_communicator][mpilist_comm_to_offset[mpi_communicator]].root;
-								switch (mpi_type) {
-									case EV_MPI_Bcast:					//7
-										if (mpi_isroot) {
-											ev.type = SENDING;
-											ev.task = 0; //Events don't have tags
-											ev.length = mpi_sendsize;
-											ev.count = 0; // Packets sent or received
-											ev.mpitype = (enum coll_ev_t) mpi_type;
-											for (t_id = 0; t_id < communicator_map[mpi_communicator]->size; t_id++) {
-												ev.pid = communicator_map[mpi_communicator]->process[t_id];
-												ins_event(g_generators_list, trace_id, instances, task_id, ev);
-											}
-										} else {
-											//root is unknown, we wait for any Bcast
-											ev.type = RECEPTION;
-											ev.task = 0; //Events don't have tags
-											ev.length = mpi_recvsize;
-											ev.count = 0; // Packets sent or received
-											ev.pid = -1;
-											ev.mpitype = (enum coll_ev_t) mpi_type;
-											ev.pid = root;
-											ins_event(g_generators_list, trace_id, instances, task_id, ev);
-										}
-										break;
-									case EV_MPI_Alltoall: //11
-									case EV_MPI_Barrier: //8
-									case EV_MPI_Allreduce: //10
-									case EV_MPI_Alltoallv: //12
-										if (mpi_isroot) cerr << "A root in Alltoall\n" << endl;
-										assert(!mpi_isroot);
-										ev.task = 0; //Events don't have tags
-										ev.count = 0; // Packets sent or received
-										ev.mpitype = (enum coll_ev_t) mpi_type;
-										if (mpi_type == EV_MPI_Alltoallv) {
-											//We cannot do anything better...
-											mpi_sendsize = mpi_recvsize = 1;
-										}
-										long stride;
-										ev.length = mpi_sendsize;
-#if DEBUG
-										cout << "Even length = " << ev.length << endl;
-#endif
-										for (stride = 1; stride < communicator_map[mpi_communicator]->size; stride++) {
-											long g = gcd(stride, communicator_map[mpi_communicator]->size);
-											if ((task_id / g) & 1)
-												t_id = (task_id + communicator_map[mpi_communicator]->size - stride)
-														% communicator_map[mpi_communicator]->size;
-											else
-												t_id = (task_id + stride) % communicator_map[mpi_communicator]->size;
-											ev.pid = communicator_map[mpi_communicator]->process[t_id];
-											ev.type = SENDING;
-											ins_event(g_generators_list, trace_id, instances, task_id, ev);
-											ev.type = RECEPTION;
-											ins_event(g_generators_list, trace_id, instances, task_id, ev);
-										}
-										break;
-									case EV_MPI_Reduce:								//9
-										if (mpi_isroot) {
-											ev.type = RECEPTION;
-											ev.task = 0; //Events don't have tags
-											ev.length = mpi_recvsize;
-											ev.count = 0; // Packets sent or received
-											ev.mpitype = (enum coll_ev_t) mpi_type;
-											for (t_id = 0; t_id < communicator_map[mpi_communicator]->size; t_id++) {
-												if (communicator_map[mpi_communicator]->process[t_id] == task_id)
-													continue;
-												ev.pid = communicator_map[mpi_communicator]->process[t_id];
-												ins_event(g_generators_list, trace_id, instances, task_id, ev);
+								if (communicator_map.count(mpi_communicator) == 0) {
+									cerr << "Undefined communicator " << mpi_communicator << endl;
+									assert(0);
+								}
+								{
+									/* Expand the collective over communicator ranks (reusing the
+									 * schedule if already expanded), and relabel ranks as tasks */
+									communicator *comm = communicator_map[mpi_communicator];
+									vector<long> &ranks = communicator_ranks[mpi_communicator];
+									long rank, root_rank = 0;
+									if (ranks.empty()) {
+										ranks.assign(g_trace_nodes[trace_id], -1);
+										for (x = 0; x < comm->size; x++)
+											ranks[comm->process[x]] = x;
+									}
+									rank = ranks[task_id];
+									if (rank < 0) cerr << "Task " << task_id << " is not in communicator " << mpi_communicator << endl;
+									assert(rank >= 0);
+									switch (mpi_type) {
+										case EV_MPI_Bcast:					//7
+										case EV_MPI_Reduce:					//9
+											root_rank = mpi_isroot ? rank : ranks[root];
+											assert(root_rank >= 0);
+											break;
+										case EV_MPI_Alltoall: //11
+										case EV_MPI_Barrier: //8
+										case EV_MPI_Allreduce: //10
+										case EV_MPI_Alltoallv: //12
+											if (mpi_isroot) cerr << "A root in Alltoall\n" << endl;
+											assert(!mpi_isroot);
+											if (mpi_type == EV_MPI_Alltoallv) {
+												//We cannot do anything better...
+												mpi_sendsize = mpi_recvsize = 1;
 											}
-										} else {
-											ev.type = SENDING;
-											ev.task = 0; //Events don't have tags
-											ev.length = mpi_sendsize;
-											ev.count = 0; // Packets sent or received
-											ev.pid = -1;
-											ev.mpitype = (enum coll_ev_t) mpi_type;
-											ev.pid = root;
-											ins_event(g_generators_list, trace_id, instances, task_id, ev);
-										}
-										break;
-									default:
-										cerr << "Implement me!" << endl;
-										assert(0);
-										break;
+											break;
+										default:
+											cerr << "Implement me!" << endl;
+											assert(0);
+											break;
+									}
+									const vector<collective_step> &steps = collectives.getSchedule(mpi_type, comm->size,
+											root_rank, rank, mpi_sendsize, mpi_recvsize);
+									ev.task = 0; //Events don't have tags
+									ev.count = 0; // Packets sent or received
+									ev.mpitype = (enum coll_ev_t) mpi_type;
+									for (x = 0; x < steps.size(); x++) {
+										ev.type = steps[x].type;
+										ev.length = steps[x].length;
+										ev.pid = comm->process[steps[x].peer];
+										program->addEvent(task_id, ev);
+									}
 								}
 								//clean
 								mpi_type = -1;
@@ -680,7 +700,7 @@ void read_dimemas(int trace_id, vector<int> instances) {
 #if DEBUG
 									cout << "MPI_Init: Flushing " << i << endl;
 #endif
-									clear_event(g_generators_list, trace_id, instances, task_id);
+									program->clearTask(task_id);
 								}
 								break;
 							case MPI_Comm_size:
@@ -854,23 +874,10 @@ void read_dimemas(int trace_id, vector<int> instances) {
 				cout << "WARNING: There is an Unexpected operation!!!\n" << endl;
 		}
 	}
-	fclose(ftrc);
-
-	for (int j = 0; j < instances.size(); j++) {
-		bool trace_empty = true;
-		for (int k = 0; k < g_trace_nodes[trace_id]; k++) {
-			assert(g_trace_2_gen_map[trace_id][k][j] < g_number_generators); // Sanity check
-			if (!g_generators_list[g_trace_2_gen_map[trace_id][k][j]]->isGenerationEnded()) {
-				trace_empty = false;
-				break;
-			}
-		}
-		if (trace_empty)
-			cerr << "Error when loading trace " << trace_id << ", instance " << j << ": event queues are empty!"
-					<< endl;
-		assert(!trace_empty); // Sanity check, to ensure trace instance has been properly loaded
-	}
+	delete ftrc;
 
+	cout << "Collective schedules: " << collectives.getNumTemplates() << " expanded, " << collectives.getNumHits()
+			<< " reused" << endl;
 	cout << "<<read_dimemas" << endl;
 }
 
@@ -29,10 +29,11 @@
 #define FILE_TIME 73		///< Default delay for accessing a file.
 #define FILE_SCALE 3		///< Default scale for file accesses based on the size.
 #define BUFSIZE 131072		///< The size of the buffer,
-void read_dimemas(int trace_id, vector<int> instances);
+void read_dimemas(int trace_id, traceProgram *program);
 void read_fsin_trc();
 void read_alog();
 void read_trace(int trace_id, vector<int> instances);
+traceProgram * compile_trace(int trace_id, const char *spill_file = NULL, long spill_budget = 0);
 
 void random_placement();
 void consecutive_placement();
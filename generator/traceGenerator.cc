@@ -19,6 +19,7 @@
  */
 
 #include "traceGenerator.h"
+#include "traceScheduler.h"
 #include <math.h>
 
 traceGenerator::traceGenerator(int interArrivalTime, string name, int sourceLabel, int pPos, int aPos, int hPos,
@@ -26,6 +27,9 @@ traceGenerator::traceGenerator(int interArrivalTime, string name, int sourceLabe
 		generatorModule(interArrivalTime, name, sourceLabel, pPos, aPos, hPos, switchM) {
 	saved_packet = NULL;
 	pending_packet = 0;
+	m_lastRun = 0;
+	m_computing = false;
+	m_drained = true;
 	init_event(&events);
 	init_occur(&occurs);
 }
@@ -35,17 +39,12 @@ traceGenerator::~traceGenerator() {
 }
 
 void traceGenerator::action() {
-	int sourceA, sourceP, sourceH, destP, destA, destH, valP, valA, valH, rand_num, instance;
+	int sourceA, sourceP, sourceH, destP, destA, destH, valP, valA, valH, rand_num;
 
 	event e;
 	if (!event_empty(&events) && head_event(&events).type == COMPUTATION) {
 		do_event(&events, &e);
-		TraceNodeId trace_node = g_gen_2_trace_map[sourceLabel];
-		for (instance = 0; instance < g_trace_instances[trace_node.trace_id]; instance++) {
-			if (g_trace_2_gen_map[trace_node.trace_id][trace_node.trace_node][instance] == sourceLabel) break;
-		}
-		assert(instance < g_trace_instances[trace_node.trace_id]);
-		g_event_deadlock[trace_node.trace_id][instance] = 0;
+		recordProgress(g_cycle);
 	}
 
 	flit = this->generateFlit();
@@ -91,6 +90,7 @@ void traceGenerator::action() {
 			pending_packet = 1;
 		}
 	}
+	notifyCompletion();
 }
 
 /* Creates a new flit upon trace behavior. If a previous flit is pending
@@ -121,14 +121,7 @@ flitModule* traceGenerator::generateFlit() {
 			}
 			if (!event_empty(&events) && head_event(&events).type == SENDING) {
 				/* SENDING event */
-				int instance;
-				TraceNodeId trace_node = g_gen_2_trace_map[sourceLabel];
-				for (instance = 0; instance < g_trace_instances[trace_node.trace_id]; instance++) {
-					if (g_trace_2_gen_map[trace_node.trace_id][trace_node.trace_node][instance] == sourceLabel) break;
-				}
-				assert(instance < g_trace_instances[trace_node.trace_id]);
-				assert(g_trace_2_gen_map[trace_node.trace_id][trace_node.trace_node][instance] == sourceLabel);
-				g_event_deadlock[trace_node.trace_id][instance] = 0;
+				recordProgress(g_cycle);
 				do_event(&events, &e);
 				destId = e.pid;
 				if (destId >= g_number_generators) cerr << "destGenerator=" << destId << endl;
@@ -142,14 +135,14 @@ flitModule* traceGenerator::generateFlit() {
 				}
 
 				destSw = floor(destId / g_p_computing_nodes_per_router);
-				if (destSwitch >= g_number_switches) cerr << "destSwitch=" << destSwitch << endl;
-				assert(destSwitch < g_number_switches);
+				if (destSw >= g_number_switches) cerr << "destSwitch=" << destSw << endl;
+				assert(destSw < g_number_switches);
 
 				genFlit = new flitModule(g_tx_packet_counter, g_tx_flit_counter, m_flitSeq, sourceLabel, destId, destSw,
 						0, 1, 1);
-				flit->task = e.task;
-				flit->length = e.length;
-				flit->mpitype = e.mpitype;
+				genFlit->task = e.task;
+				genFlit->length = e.length;
+				genFlit->mpitype = e.mpitype;
 			}
 		}
 	}
@@ -171,29 +164,6 @@ void traceGenerator::printHeadEvent() {
 	}
 }
 
-/* Returns the number of cycles that can be skipped in
- * current generator list of events. Only computation
- * events can be skipped; reception events or empty
- * queues do not alter number of cycles that can be
- * skipped, and return a '-1' flag.
- */
-int traceGenerator::numSkipCycles() {
-	event e;
-	int numCycles = -1;
-
-	if (event_empty(&this->events)) return -1;
-
-	e = head_event(&this->events);
-	switch (e.type) {
-		case RECEPTION:
-			return -1;
-		case COMPUTATION:
-			return (e.length - e.count);
-		default:
-			return 0;
-	}
-}
-
 void traceGenerator::consumeCycles(int numCycles) {
 	if (!event_empty(&this->events) && head_event(&this->events).type != RECEPTION) {
 		event e = head_event(&this->events);
@@ -202,28 +172,16 @@ void traceGenerator::consumeCycles(int numCycles) {
 	}
 }
 
-/* Removes all elements of the events queue.
- */
-void traceGenerator::resetEventQueue() {
-	while (this->events.head)
-		rem_head_event(&this->events);
-}
-
-/* Inserts an event into the events queue.
+/* Replaces the events queue with the event stream of a trace task. Destination
+ * PIDs are translated on the fly to reflect trace distribution.
  */
-void traceGenerator::insertEvent(event i, int destId) {
-	event_n *e;
-	e = new event_n;
-	e->ev = i;
-	e->ev.pid = destId;	// Update destination PID to reflect trace distribution
-	e->next = NULL;
-	if (this->events.head == NULL) { // Empty Queue
-		this->events.head = e;
-		this->events.tail = e;
-	} else {
-		this->events.tail->next = e;
-		this->events.tail = e;
-	}
+void traceGenerator::loadEvents(const traceProgram *program, int traceId, int taskId, int instance) {
+	load_events(&this->events, program, traceId, taskId, instance);
+	m_lastRun = g_cycle;
+	m_computing = false;
+	recordProgress(g_cycle);
+	notifyCompletion();
+	if (g_trace_scheduler != NULL) g_trace_scheduler->activate(sourceLabel);
 }
 
 void traceGenerator::insertOccurredEvent(flitModule *flit) {
@@ -234,4 +192,62 @@ void traceGenerator::insertOccurredEvent(flitModule *flit) {
 	e.length = flit->length;
 	e.mpitype = (enum coll_ev_t) flit->mpitype;
 	ins_occur(&this->occurs, e);
+	if (g_trace_scheduler != NULL) g_trace_scheduler->activate(sourceLabel);
+}
+
+/* Called before running a generator that was sleeping: accounts the cycles
+ * of its computation event elapsed since it last run.
+ */
+void traceGenerator::resumeRun() {
+	if (m_computing && g_cycle - m_lastRun > 1) consumeCycles(g_cycle - m_lastRun - 1);
+	m_computing = false;
+}
+
+/* Returns the next cycle the generator needs to run at, upon its head event,
+ * or LLONG_MAX if it has to wait for a packet arrival or a trace reload.
+ */
+long long traceGenerator::scheduleNextRun() {
+	event e;
+	m_lastRun = g_cycle;
+	m_computing = false;
+	if (pending_packet || event_empty(&this->events)) return pending_packet ? g_cycle + 1 : LLONG_MAX;
+
+	e = head_event(&this->events);
+	switch (e.type) {
+		case RECEPTION:
+			return has_occurred(&this->occurs, e) ? g_cycle + 1 : LLONG_MAX;
+		case COMPUTATION:
+			if (e.length - e.count > 1) {
+				/* Computation keeps the trace instance alive while sleeping */
+				recordProgress(g_cycle + e.length - e.count);
+				m_computing = true;
+			}
+			return g_cycle + max(e.length - e.count, 1L);
+		default:
+			return g_cycle + 1;
+	}
+}
+
+/* Notifies the trace instance when the event queue drains or gets refilled,
+ * so that instance completion does not require polling every generator.
+ */
+void traceGenerator::notifyCompletion() {
+	bool drained = event_empty(&this->events);
+	if (drained == m_drained) return;
+	m_drained = drained;
+	int &active = g_trace_active_nodes[this->events.trace_id][this->events.instance];
+	if (drained) {
+		assert(active > 0);
+		if (--active == 0) g_trace_drained.push_back(make_pair(this->events.trace_id, this->events.instance));
+	} else {
+		active++;
+	}
+}
+
+/* Records the trace instance has progressed (or will stay busy computing)
+ * up to given cycle, for event deadlock detection.
+ */
+void traceGenerator::recordProgress(long long cycle) {
+	long long &progress = g_event_progress[this->events.trace_id][this->events.instance];
+	if (progress < cycle) progress = cycle;
 }
@@ -27,6 +27,11 @@ class traceGenerator: public generatorModule {
 private:
 	flitModule *saved_packet;
 	bool pending_packet;
+	long long m_lastRun; /* Last cycle the generator was run (or its events loaded) */
+	bool m_computing; /* Sleeping until its head computation event ends */
+	bool m_drained; /* Event queue empty, as last notified to its trace instance */
+	void notifyCompletion();
+	void recordProgress(long long cycle);
 
 public:
 	event_q events; /* Queue to store trace events  */
@@ -38,11 +43,11 @@ public:
 	flitModule* generateFlit();
 	bool isGenerationEnded();
 	void printHeadEvent();
-	int numSkipCycles();
 	void consumeCycles(int numCycles);
-	void resetEventQueue();
-	void insertEvent(event i, int destId);
+	void loadEvents(const traceProgram *program, int traceId, int taskId, int instance);
 	void insertOccurredEvent(flitModule *flit);
+	void resumeRun();
+	long long scheduleNextRun();
 };
 
 #endif /* TRACEGENERATOR_H_ */
@@ -0,0 +1,109 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tracePrefetcher.h"
+#include <algorithm>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+tracePrefetcher::tracePrefetcher(const traceProgram *program, int numInstances, long window) {
+	assert(program->isMapped());
+	assert(numInstances > 0 && window > 1);
+	m_program = program;
+	m_window = window;
+	m_pageSize = sysconf(_SC_PAGESIZE);
+	m_positions.assign(program->getNumTasks(), vector<long>(numInstances, 0));
+	m_released.assign(program->getNumTasks(), 0);
+	m_closing = false;
+	m_helper = thread(&tracePrefetcher::helperLoop, this);
+}
+
+tracePrefetcher::~tracePrefetcher() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_closing = true;
+	}
+	m_cond.notify_all();
+	m_helper.join();
+}
+
+/*
+ * Posts the position (event index within its task stream) of a cursor.
+ */
+void tracePrefetcher::advance(int task, int instance, long position) {
+	cursorUpdate update = { task, instance, position };
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_updates.push_back(update);
+	}
+	m_cond.notify_one();
+}
+
+void tracePrefetcher::helperLoop() {
+	vector<cursorUpdate> updates;
+	unique_lock<mutex> lock(m_mutex);
+	while (true) {
+		m_cond.wait(lock, [this] {return !m_updates.empty() || m_closing;});
+		if (m_closing) break;
+		updates.swap(m_updates);
+		lock.unlock();
+		for (int i = 0; i < updates.size(); i++) {
+			m_positions[updates[i].task][updates[i].instance] = updates[i].position;
+			prefetch(updates[i].task, updates[i].position);
+			release(updates[i].task);
+		}
+		updates.clear();
+		lock.lock();
+	}
+}
+
+/*
+ * Faults in the pages holding the next window of events of a task.
+ */
+void tracePrefetcher::prefetch(int task, long position) {
+	const packed_event *begin = m_program->taskBegin(task) + position;
+	const packed_event *end = min(begin + m_window, m_program->taskEnd(task));
+	if (begin >= end) return;
+	uintptr_t from = (uintptr_t) begin & ~(uintptr_t) (m_pageSize - 1);
+	uintptr_t to = (uintptr_t) end;
+	madvise((void *) from, to - from, MADV_WILLNEED);
+	for (uintptr_t page = from; page < to; page += m_pageSize)
+		(void) *(volatile const char *) page;
+}
+
+/*
+ * Drops the pages holding events of a task that every instance has already
+ * consumed. Pages shared with pending events are kept; dropped pages of the
+ * (read-only) mapping are read again from the file if an instance restarts.
+ */
+void tracePrefetcher::release(int task) {
+	long slowest = *min_element(m_positions[task].begin(), m_positions[task].end());
+	if (slowest <= m_released[task]) {
+		m_released[task] = slowest;
+		return;
+	}
+	uintptr_t from = (uintptr_t) (m_program->taskBegin(task) + m_released[task]);
+	uintptr_t to = (uintptr_t) (m_program->taskBegin(task) + slowest);
+	from = (from + m_pageSize - 1) & ~(uintptr_t) (m_pageSize - 1);
+	to &= ~(uintptr_t) (m_pageSize - 1);
+	if (from < to) madvise((void *) from, to - from, MADV_DONTNEED);
+	m_released[task] = slowest;
+}
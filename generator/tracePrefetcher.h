@@ -0,0 +1,67 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRACEPREFETCHER_H_
+#define TRACEPREFETCHER_H_
+
+#include "../global.h"
+#include "event.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*
+ * Windowed streaming of a binary (mapped) trace. Only a bounded window of
+ * events ahead of every task cursor is kept resident: a helper thread faults
+ * in the next window when a cursor reaches half of the current one, and
+ * releases the pages already consumed by every instance of the trace. The
+ * simulation loop only posts cursor positions, so it never waits on I/O
+ * unless it runs ahead of the prefetched window.
+ */
+class tracePrefetcher {
+public:
+	tracePrefetcher(const traceProgram *program, int numInstances, long window);
+	~tracePrefetcher();
+	inline long getWindow() const {
+		return m_window;
+	}
+	void advance(int task, int instance, long position);
+private:
+	struct cursorUpdate {
+		int task;
+		int instance;
+		long position;
+	};
+	const traceProgram *m_program;
+	long m_window; /* Events per task kept ahead of the cursors */
+	long m_pageSize;
+	vector<cursorUpdate> m_updates; /* Pending cursor positions, posted by the simulator */
+	vector<vector<long> > m_positions; /* Last known position, per task and instance */
+	vector<long> m_released; /* Events of every task whose pages have been released */
+	bool m_closing;
+	mutex m_mutex;
+	condition_variable m_cond;
+	thread m_helper;
+	void helperLoop();
+	void prefetch(int task, long position);
+	void release(int task);
+};
+
+#endif /* TRACEPREFETCHER_H_ */
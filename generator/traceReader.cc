@@ -0,0 +1,246 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "traceReader.h"
+#include <iostream>
+#include <cstring>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+traceReader::traceReader(const char *fileName) {
+	m_fileName = fileName;
+	m_compression = detectCompression(fileName);
+#ifndef HAVE_ZSTD
+	if (m_compression == TRACE_ZSTD) {
+		cerr << "ERROR: trace " << fileName << " is zstd-compressed, but fogsim was built without zstd support "
+				<< "(rebuild with 'make ZSTD=1')" << endl;
+		exit(-1);
+	}
+#endif
+	if ((m_file = fopen(fileName, "rb")) == NULL) {
+		cerr << "ERROR: trace file " << fileName << " not found" << endl;
+		exit(-1);
+	}
+	m_pos = 0;
+	m_eof = false;
+	m_closing = false;
+	m_helper = thread(&traceReader::helperLoop, this);
+}
+
+traceReader::~traceReader() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_closing = true;
+	}
+	m_cond.notify_all();
+	m_helper.join();
+	fclose(m_file);
+}
+
+/*
+ * Determines upon its magic number whether a trace file is compressed.
+ */
+TraceCompression traceReader::detectCompression(const char *fileName) {
+	unsigned char magic[4];
+	size_t n = 0;
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) return TRACE_PLAIN;
+	n = fread(magic, 1, 4, file);
+	fclose(file);
+	if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return TRACE_GZIP;
+	if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) return TRACE_ZSTD;
+	return TRACE_PLAIN;
+}
+
+/*
+ * Reads next line (newline included) into buffer, as fgets() does. Returns
+ * NULL once the whole trace has been read.
+ */
+char * traceReader::getLine(char *buffer, int size) {
+	int n = 0;
+	while (n < size - 1) {
+		if (m_pos >= m_current.size()) {
+			if (!nextChunk()) break;
+			continue;
+		}
+		size_t avail = min(m_current.size() - m_pos, (size_t) (size - 1 - n));
+		const char *start = &m_current[m_pos];
+		const char *newline = (const char *) memchr(start, '\n', avail);
+		size_t length = (newline != NULL) ? newline - start + 1 : avail;
+		memcpy(buffer + n, start, length);
+		n += length;
+		m_pos += length;
+		if (newline != NULL) break;
+	}
+	if (n == 0) return NULL;
+	buffer[n] = '\0';
+	return buffer;
+}
+
+/*
+ * Takes next decompressed chunk, waiting for the helper if needed.
+ */
+bool traceReader::nextChunk() {
+	unique_lock<mutex> lock(m_mutex);
+	m_cond.wait(lock, [this] {return !m_chunks.empty() || m_eof;});
+	if (m_chunks.empty()) return false;
+	m_current.swap(m_chunks.front());
+	m_chunks.pop_front();
+	m_pos = 0;
+	lock.unlock();
+	m_cond.notify_all();
+	return true;
+}
+
+/*
+ * Queues a decompressed chunk (emptying it), blocking while the parser is
+ * MAX_CHUNKS behind. Returns false if the reader is being closed.
+ */
+bool traceReader::pushChunk(vector<char> &chunk) {
+	unique_lock<mutex> lock(m_mutex);
+	m_cond.wait(lock, [this] {return m_chunks.size() < MAX_CHUNKS || m_closing;});
+	if (m_closing) return false;
+	m_chunks.push_back(vector<char>());
+	m_chunks.back().swap(chunk);
+	lock.unlock();
+	m_cond.notify_all();
+	return true;
+}
+
+void traceReader::helperLoop() {
+	switch (m_compression) {
+		case TRACE_GZIP:
+			readGzip();
+			break;
+		case TRACE_ZSTD:
+			readZstd();
+			break;
+		default:
+			readPlain();
+			break;
+	}
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_eof = true;
+	}
+	m_cond.notify_all();
+}
+
+void traceReader::readPlain() {
+	vector<char> chunk;
+	size_t n;
+	while (true) {
+		chunk.resize(CHUNK_SIZE);
+		if ((n = fread(&chunk[0], 1, CHUNK_SIZE, m_file)) == 0) break;
+		chunk.resize(n);
+		if (!pushChunk(chunk)) break;
+	}
+}
+
+/*
+ * Inflates a gzip file, including files made of several concatenated
+ * gzip members (as produced by parallel compressors).
+ */
+void traceReader::readGzip() {
+	vector<char> in(CHUNK_SIZE), chunk;
+	z_stream stream;
+	bool stream_end = false, output_full = false;
+	int ret;
+
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+		cerr << "ERROR: can't initialize gzip decompression of trace " << m_fileName << endl;
+		exit(-1);
+	}
+	while (true) {
+		if (stream.avail_in == 0 && !output_full) {
+			stream.avail_in = fread(&in[0], 1, CHUNK_SIZE, m_file);
+			stream.next_in = (Bytef *) &in[0];
+			if (stream.avail_in == 0) break;
+		}
+		chunk.resize(CHUNK_SIZE);
+		stream.next_out = (Bytef *) &chunk[0];
+		stream.avail_out = CHUNK_SIZE;
+		ret = inflate(&stream, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+			cerr << "ERROR: corrupted gzip trace " << m_fileName << " (" << (stream.msg ? stream.msg : "") << ")"
+					<< endl;
+			exit(-1);
+		}
+		if (ret == Z_BUF_ERROR) { /* Nothing left pending */
+			output_full = false;
+			continue;
+		}
+		stream_end = (ret == Z_STREAM_END);
+		if (stream_end) inflateReset(&stream);
+		output_full = (stream.avail_out == 0); /* Inflated data may be pending */
+		chunk.resize(CHUNK_SIZE - stream.avail_out);
+		if (!chunk.empty() && !pushChunk(chunk)) {
+			stream_end = true;
+			break;
+		}
+	}
+	inflateEnd(&stream);
+	if (!stream_end) {
+		cerr << "ERROR: gzip trace " << m_fileName << " is truncated" << endl;
+		exit(-1);
+	}
+}
+
+void traceReader::readZstd() {
+#ifdef HAVE_ZSTD
+	vector<char> in(CHUNK_SIZE), chunk;
+	ZSTD_DStream *stream = ZSTD_createDStream();
+	ZSTD_inBuffer input = { &in[0], 0, 0 };
+	size_t ret, pending = 0, consumed;
+	bool closed = false, output_full = false;
+
+	ZSTD_initDStream(stream);
+	while (true) {
+		if (input.pos == input.size && !output_full) {
+			input.size = fread(&in[0], 1, CHUNK_SIZE, m_file);
+			input.pos = 0;
+			if (input.size == 0) break;
+		}
+		chunk.resize(CHUNK_SIZE);
+		ZSTD_outBuffer output = { &chunk[0], CHUNK_SIZE, 0 };
+		consumed = input.pos;
+		ret = ZSTD_decompressStream(stream, &output, &input);
+		if (ZSTD_isError(ret)) {
+			cerr << "ERROR: corrupted zstd trace " << m_fileName << " (" << ZSTD_getErrorName(ret) << ")" << endl;
+			exit(-1);
+		}
+		if (output.pos > 0 || input.pos != consumed) pending = ret; /* 0 once a frame is complete */
+		output_full = (output.pos == output.size); /* Decompressed data may be pending */
+		chunk.resize(output.pos);
+		if (!chunk.empty() && !pushChunk(chunk)) {
+			closed = true;
+			break;
+		}
+	}
+	ZSTD_freeDStream(stream);
+	if (pending != 0 && !closed) {
+		cerr << "ERROR: zstd trace " << m_fileName << " is truncated" << endl;
+		exit(-1);
+	}
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRACEREADER_H_
+#define TRACEREADER_H_
+
+#include "../global.h"
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+enum TraceCompression {
+	TRACE_PLAIN, TRACE_GZIP, TRACE_ZSTD
+};
+
+/*
+ * Line reader for text traces, either plain or compressed with gzip or
+ * zstd (detected upon their magic number). A helper thread reads and
+ * decompresses the file into a bounded queue of chunks, so decompression
+ * overlaps with trace parsing; lines are handed out as fgets() would.
+ */
+class traceReader {
+public:
+	traceReader(const char *fileName);
+	~traceReader();
+	char * getLine(char *buffer, int size);
+	static TraceCompression detectCompression(const char *fileName);
+private:
+	static const size_t CHUNK_SIZE = 1 << 20; /* Bytes per decompressed chunk */
+	static const size_t MAX_CHUNKS = 8; /* Chunks read ahead of the parser */
+	string m_fileName;
+	FILE *m_file;
+	TraceCompression m_compression;
+	deque<vector<char> > m_chunks; /* Decompressed data, ready to be parsed */
+	vector<char> m_current; /* Chunk being parsed */
+	size_t m_pos; /* Parsing position within current chunk */
+	bool m_eof; /* Helper has queued the whole file */
+	bool m_closing;
+	mutex m_mutex;
+	condition_variable m_cond;
+	thread m_helper;
+	void helperLoop();
+	bool pushChunk(vector<char> &chunk);
+	bool nextChunk();
+	void readPlain();
+	void readGzip();
+	void readZstd();
+};
+
+#endif /* TRACEREADER_H_ */
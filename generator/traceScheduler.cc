@@ -0,0 +1,98 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "traceScheduler.h"
+#include "traceGenerator.h"
+#include <algorithm>
+
+traceScheduler::traceScheduler(int numGenerators) {
+	m_nextRun.assign(numGenerators, LLONG_MAX);
+}
+
+/*
+ * Wakes up a waiting (or computing) generator, to run in the current cycle
+ * if generators have not run yet, or in the next one otherwise.
+ */
+void traceScheduler::activate(int gen) {
+	if (m_nextRun[gen] <= g_cycle) return; /* Already due */
+	m_nextRun[gen] = g_cycle;
+	m_activated.push_back(gen);
+}
+
+/*
+ * Runs (in index order, as a full sweep would) every generator due this
+ * cycle, and schedules their next run upon their head event.
+ */
+void traceScheduler::runGenerators() {
+	int i, gen;
+	long long next;
+	bool merged = !m_activated.empty();
+
+	m_run.swap(m_due);
+	m_due.clear();
+	m_run.insert(m_run.end(), m_activated.begin(), m_activated.end());
+	m_activated.clear();
+	while (!m_wakeUps.empty() && m_wakeUps.top().first <= g_cycle) {
+		if (m_nextRun[m_wakeUps.top().second] == m_wakeUps.top().first) {
+			m_run.push_back(m_wakeUps.top().second);
+			merged = true;
+		}
+		m_wakeUps.pop();
+	}
+	if (merged) {
+		sort(m_run.begin(), m_run.end());
+		m_run.erase(unique(m_run.begin(), m_run.end()), m_run.end());
+	}
+
+	for (i = 0; i < m_run.size(); i++) {
+		gen = m_run[i];
+		assert(m_nextRun[gen] <= g_cycle);
+		traceGenerator *generator = (traceGenerator *) g_generators_list[gen];
+		generator->resumeRun();
+		generator->action();
+		next = generator->scheduleNextRun();
+		m_nextRun[gen] = next;
+		if (next == g_cycle + 1)
+			m_due.push_back(gen);
+		else if (next != LLONG_MAX) m_wakeUps.push(wakeUp(next, gen));
+	}
+	m_run.clear();
+}
+
+void traceScheduler::dropStaleWakeUps() {
+	while (!m_wakeUps.empty() && m_nextRun[m_wakeUps.top().second] != m_wakeUps.top().first)
+		m_wakeUps.pop();
+}
+
+/*
+ * No generator has to run in the current cycle.
+ */
+bool traceScheduler::isIdle() {
+	dropStaleWakeUps();
+	return m_due.empty() && m_activated.empty() && (m_wakeUps.empty() || m_wakeUps.top().first > g_cycle);
+}
+
+/*
+ * Earliest cycle a sleeping generator has to run at (LLONG_MAX if none).
+ */
+long long traceScheduler::nextWakeCycle() {
+	dropStaleWakeUps();
+	return m_wakeUps.empty() ? LLONG_MAX : m_wakeUps.top().first;
+}
@@ -0,0 +1,56 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRACESCHEDULER_H_
+#define TRACESCHEDULER_H_
+
+#include "../global.h"
+#include <queue>
+
+/*
+ * Activity-driven scheduling of trace generators. Rather than calling every
+ * generator each cycle, a generator only runs when it can make progress:
+ * generators with messages to send run every cycle, generators in the middle
+ * of a computation sleep until it ends (their elapsed cycles are accounted at
+ * once), and generators waiting for a reception (or with no events left)
+ * sleep until a packet arrives for them or their trace is reloaded.
+ *
+ * Wake-up cycles are kept in a priority queue, so that when the network
+ * drains and no generator is due, the clock can jump straight to the next
+ * wake-up, while busy instances do not prevent others from skipping cycles.
+ */
+class traceScheduler {
+public:
+	traceScheduler(int numGenerators);
+	void activate(int gen);
+	void runGenerators();
+	bool isIdle();
+	long long nextWakeCycle();
+private:
+	typedef pair<long long, int> wakeUp;
+	vector<long long> m_nextRun; /* Per generator; LLONG_MAX while waiting */
+	vector<int> m_due; /* Generators to run next cycle, in index order */
+	vector<int> m_activated; /* Generators woken up by arrivals or trace reloads */
+	vector<int> m_run;
+	priority_queue<wakeUp, vector<wakeUp>, greater<wakeUp> > m_wakeUps;
+	void dropStaleWakeUps();
+};
+
+#endif /* TRACESCHEDULER_H_ */
@@ -21,8 +21,8 @@
 #include "all2all.h"
 #include "../generatorModule.h"
 
-all2allTraffic::all2allTraffic(int sourceLabel, int pPos, int aPos, int hPos) :
-		steadyTraffic(sourceLabel, pPos, aPos, hPos) {
+all2allTraffic::all2allTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos) :
+		steadyTraffic(generator, sourceLabel, pPos, aPos, hPos) {
 	assert(g_traffic == ALL2ALL);
 	flits_tx_count = 0;
 	flits_rx_count = 0;
@@ -37,7 +37,7 @@ protected:
 	bool isPhaseRx();
 
 public:
-	all2allTraffic(int sourceLabel, int pPos, int aPos, int hPos);
+	all2allTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos);
 	~all2allTraffic();
 	int setDestination(TrafficType type);
 	bool isGenerationFinished();
@@ -20,8 +20,8 @@
 
 #include "burst.h"
 
-burstTraffic::burstTraffic(int sourceLabel, int pPos, int aPos, int hPos) :
-		steadyTraffic(sourceLabel, pPos, aPos, hPos) {
+burstTraffic::burstTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos) :
+		steadyTraffic(generator, sourceLabel, pPos, aPos, hPos) {
 	assert(g_traffic == SINGLE_BURST);
 	flits_tx_count = 0;
 	flits_rx_count = 0;
@@ -40,7 +40,7 @@ int burstTraffic::setDestination(TrafficType type) {
 
 	/* Shuffle randomly between the 3 possible
 	 * different traffic patterns */
-	random = rand() % 100 + 1;
+	random = trafficRand() % 100 + 1;
 	if (random <= g_phase_traffic_percent[0]) {
 		aux = 0;
 	} else if (random <= g_phase_traffic_percent[0] + g_phase_traffic_percent[1]) {
@@ -30,7 +30,7 @@ protected:
 	int flits_rx_count;
 
 public:
-	burstTraffic(int sourceLabel, int pPos, int aPos, int hPos);
+	burstTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos);
 	~burstTraffic();
 	int setDestination(TrafficType type);
 	bool isGenerationFinished();
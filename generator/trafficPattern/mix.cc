@@ -20,8 +20,8 @@
 
 #include "mix.h"
 
-mixTraffic::mixTraffic(int sourceLabel, int pPos, int aPos, int hPos) :
-		steadyTraffic(sourceLabel, pPos, aPos, hPos) {
+mixTraffic::mixTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos) :
+		steadyTraffic(generator, sourceLabel, pPos, aPos, hPos) {
 	assert(g_traffic == MIX);
 }
 
@@ -34,7 +34,7 @@ int mixTraffic::setDestination(TrafficType type) {
 
 	/* Shuffle randomly between the 3 possible
 	 * different traffic patterns */
-	random = rand() % 100 + 1;
+	random = trafficRand() % 100 + 1;
 	if (random <= g_phase_traffic_percent[0]) {
 		return this->steadyTraffic::setDestination(UN);
 	} else if (random <= g_phase_traffic_percent[0] + g_phase_traffic_percent[1]) {
@@ -26,7 +26,7 @@
 class mixTraffic: public steadyTraffic {
 
 public:
-	mixTraffic(int sourceLabel, int pPos, int aPos, int hPos);
+	mixTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos);
 	~mixTraffic();
 	int setDestination(TrafficType type);
 };
@@ -23,7 +23,8 @@
 #include <cmath>
 #include "../generatorModule.h"
 
-steadyTraffic::steadyTraffic(int sourceLabel, int pPos, int aPos, int hPos) {
+steadyTraffic::steadyTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos) {
+	this->generator = generator;
 	this->sourceLabel = sourceLabel;
 	this->pPos = pPos;
 	this->aPos = aPos;
@@ -35,6 +36,11 @@ steadyTraffic::~steadyTraffic() {
 
 }
 
+/* Destinations are drawn from the traffic stream of the source generator */
+int steadyTraffic::trafficRand() {
+	return generator->trafficRand();
+}
+
 /*
  * Determines destination upon specified steady traffic pattern.
  * It returns a node label different from source router (avoids
@@ -47,7 +53,7 @@ int steadyTraffic::setDestination(TrafficType type) {
 	groups = g_h_global_ports_per_router * g_a_routers_per_group + 1;
 	destGroup = module((this->hPos + g_adv_traffic_distance), groups);
 	do {
-		destNodeOffset = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_p_computing_nodes_per_router));
+		destNodeOffset = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_p_computing_nodes_per_router));
 	} while (destNodeOffset >= g_p_computing_nodes_per_router);
 
 	do {
@@ -55,7 +61,7 @@ int steadyTraffic::setDestination(TrafficType type) {
 			case UN:
 				/* Uniform Random traffic pattern. */
 				do {
-					destSwitch = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
+					destSwitch = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
 				} while ((destSwitch == g_number_switches));
 				break;
 
@@ -71,7 +77,7 @@ int steadyTraffic::setDestination(TrafficType type) {
 				 * destination is placed randomly within destination group, at
 				 * g_adv_global group distance ahead of current. */
 				do {
-					destSwOffset = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_a_routers_per_group));
+					destSwOffset = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_a_routers_per_group));
 				} while (destSwOffset >= g_a_routers_per_group);
 				destSwitch = destGroup * g_a_routers_per_group + destSwOffset;
 				break;
@@ -90,10 +96,10 @@ int steadyTraffic::setDestination(TrafficType type) {
 				 * amidst destination group. */
 				int group_dist;
 				do {
-					destSwOffset = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_a_routers_per_group));
+					destSwOffset = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_a_routers_per_group));
 				} while (destSwOffset >= g_a_routers_per_group);
 				do {
-					group_dist = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_h_global_ports_per_router - 1));
+					group_dist = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_h_global_ports_per_router - 1));
 				} while (group_dist >= g_h_global_ports_per_router - 1);
 				destGroup = module((this->hPos + group_dist + 1), groups);
 				destSwitch = destGroup * g_a_routers_per_group + destSwOffset;
@@ -111,35 +117,35 @@ int steadyTraffic::setDestination(TrafficType type) {
 				break;
 
 			case HOTREGION:
-				aux = ((double) rand() / (double) (RAND_MAX));
+				aux = ((double) trafficRand() / (double) (RAND_MAX));
 				// If random is lower than the percentage of the traffic to send to hotregion
 				if (aux <= (g_percent_traffic_to_congest / 100.0)) {
-					destSwitch = (g_percent_nodes_into_region / 100) * rand()
+					destSwitch = (g_percent_nodes_into_region / 100) * trafficRand()
 							/ (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
 					// Verification of destSwitch >=0 is below in the code
 					assert(destSwitch <= ceil(g_number_generators * g_percent_nodes_into_region / 100) - 1);
 				} else
 					do {
-						destSwitch = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
+						destSwitch = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
 					} while ((destSwitch == g_number_switches));
 				break;
 
 			case HOTSPOT:
-				aux = ((double) rand() / (double) (RAND_MAX));
+				aux = ((double) trafficRand() / (double) (RAND_MAX));
 				// If random is lower than the percentage of the traffic to send to hotspot
 				if (aux <= (g_percent_traffic_to_congest / 100.0)) {
 					destSwitch = g_hotspot_node / g_p_computing_nodes_per_router;
 					destNodeOffset = g_hotspot_node - destSwitch * g_p_computing_nodes_per_router;
 				} else
 					do {
-						destSwitch = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
+						destSwitch = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_number_switches));
 					} while ((destSwitch == g_number_switches));
 				break;
 			case RANDOMPERMUTATION:
 				// First execution, node is not selected for this generator
 				if (rpDestination == -1) {
 					do {
-						aux = rand() / (int) (((unsigned) RAND_MAX + 1) / (g_available_generators.size()));
+						aux = trafficRand() / (int) (((unsigned) RAND_MAX + 1) / (g_available_generators.size()));
 						rpDestination = g_available_generators.at(aux);
 					} while (rpDestination == sourceLabel);
 					g_available_generators.erase(g_available_generators.begin() + aux);
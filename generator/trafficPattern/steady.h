@@ -23,17 +23,21 @@
 
 #include "../../gModule.h"
 
+class generatorModule;
+
 class steadyTraffic: public gModule {
 
 protected:
+	generatorModule *generator; /* Owner of the pattern, whose traffic stream draws the destinations */
 	int sourceLabel;
 	int pPos;
 	int aPos;
 	int hPos;
+	int trafficRand();
 
 public:
 	int rpDestination;
-	steadyTraffic(int sourceLabel, int pPos, int aPos, int hPos);
+	steadyTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos);
 	~steadyTraffic();
 	virtual int setDestination(TrafficType type);
 	virtual bool isGenerationFinished();
@@ -21,8 +21,8 @@
 #include "transient.h"
 #include "../generatorModule.h"
 
-transientTraffic::transientTraffic(int sourceLabel, int pPos, int aPos, int hPos) :
-		steadyTraffic(sourceLabel, pPos, aPos, hPos) {
+transientTraffic::transientTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos) :
+		steadyTraffic(generator, sourceLabel, pPos, aPos, hPos) {
 	assert(g_traffic == TRANSIENT);
 }
 
@@ -26,7 +26,7 @@
 class transientTraffic: public steadyTraffic {
 
 public:
-	transientTraffic(int sourceLabel, int pPos, int aPos, int hPos);
+	transientTraffic(generatorModule *generator, int sourceLabel, int pPos, int aPos, int hPos);
 	~transientTraffic();
 	int setDestination(TrafficType type);
 };
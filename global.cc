@@ -30,8 +30,23 @@ long long g_max_cycles = 10000; /*						Maximum number of simulated cycles */
 long long g_warmup_cycles = g_max_cycles; /* 			Number of warm-up cycles; in those,
  *														 no general statistics are collected
  *														 (but some specific ones are) */
+long long g_steady_state_window = 0; /*					Cycles per observation of the steady-state detector,
+ *														 which may end warmup earlier (0 = not in use) */
+steadyStateDetector *g_steady_state_detector = NULL; /*	Steady-state detector (NULL if not in use) */
+float g_ci_target = 0; /*								Target relative half-width of the confidence intervals;
+ *														 simulation ends once reached (0 = not in use) */
+long long g_ci_batch_cycles = 100; /*					Initial length of the batches employed to estimate them */
+vector<CIMetric> g_ci_metrics; /*						Metrics that must reach the target precision */
+batchMeans *g_batch_means = NULL; /*					Batch-means estimator (NULL if not in use) */
 int g_print_cycles = 100; /*						Number of cycles between printing
  *														 temporary stats to the stdout. */
+bool g_print_progress = true; /*						Print temporary stats to the stdout or not */
+float g_print_interval = 0; /*							Minimum wall-clock time (in seconds) between
+ *														 temporary stats prints; 0 disables rate limiting */
+long long g_sample_cycles = 0; /*						Number of cycles between metrics samples; 0 disables
+ *														 the metrics time-series file */
+int g_sample_buffer_length = 4096; /*					Number of samples buffered before the background
+ *														 writer has to flush them */
 long long g_injection_queue_length = 999999; /* 		Injection queue size in phits */
 long long g_local_queue_length = 10; /* 				Local link queue size in phits */
 long long g_global_queue_length = 100; /* 				Global link queue size in phits */
@@ -69,6 +84,10 @@ float g_injection_probability = 1; /* 					Packet injection probability at a gen
  *														 injection rate within the network */
 char *g_output_file_name; /* 							Results filename */
 long long g_seed = 1; /* 								Employed seed (to randomize simulations) */
+int32_t g_rand_state[32]; /*								State of rand(), kept here so it can be checkpointed */
+bool g_common_random_numbers = false; /*				Traffic of every generator is drawn from a stream of
+ *														 its own, so runs that only differ in routing or
+ *														 switch parameters share the same arrivals */
 int g_allocator_iterations = 3; /* 						Number of (local/global) arbiter iterations
  *														 within an allocation cycle */
 int g_local_arbiter_speedup = 1; /* 					SpeedUp within local arbiter: number of ports to
@@ -80,12 +99,51 @@ float g_internal_speedup = 1.0; /*						SpeedUp in router frequency: router allo
  *														 cycles are conducted faster and more frequently
  *														 than simulation cycles (only with InputOutputQueueing) */
 bool g_palm_tree_configuration = 0;
+bool g_compact_tables = false; /*						Identical switch tables (routing, VC tables) are stored
+ *														 once and shared among switches */
+long long g_memory_budget = 0; /*						Max projected memory footprint, in MB; simulation is
+ *														 aborted before building the network if exceeded
+ *														 (0 = unlimited) */
 bool g_transient_stats = false; /*						Determines if temporal statistics over simulation
  *														 time are tracked or not. Mainly related to transient
  *														 and trace traffic. */
 unsigned short g_cos_levels = 1; /*						Number of Class of Service levels - Ethernet 802.1q */
 bool g_print_hists = false; /*							Chooses whether to print latency and injection
  *														 histograms or not. */
+ResultsFormat g_results_format = TEXT; /*				Output format(s) of simulation results */
+char *g_results_file_name = NULL; /*					JSON-lines results filename (records are appended) */
+map<string, string> g_config_parameters; /*				Copy of the configuration parameters in use, to be
+ *														 stored along with the results */
+int g_histogram_precision = 10; /*						Number of significant bits kept by latency and hop
+ *														 histograms (values below 2^precision are exact) */
+long long g_histogram_max_value = 1LL << 40; /*			Highest value tracked by histograms; larger ones
+ *														 are clamped into the last bucket */
+char *g_checkpoint_save_file = NULL; /*					Simulator state is stored here when warmup ends
+ *														 (NULL if not in use) */
+long long g_checkpoint_interval = 0; /*					Cycles between checkpoints after warmup (0 = only
+ *														 the one at the end of warmup) */
+char *g_checkpoint_restore_file = NULL; /*				Simulation starts from the state stored in this file,
+ *														 instead of an empty network (NULL if not in use) */
+char *g_sweep_key = NULL; /*							Parameter swept over several values in a single
+ *														 invocation (NULL if not in use) */
+vector<string> g_sweep_values; /*						Values taken by the swept parameter, one per run */
+int g_sweep_jobs = 0; /*								Max number of sweep runs simulated concurrently
+ *														 (0 = as many as available processors) */
+bool g_saturation_search = false; /*					Injection probability is swept looking for the
+ *														 saturation point, instead of taking fixed values */
+float g_saturation_tolerance = 1; /*				Width (in probability points) of the bracket around
+ *														 the saturation point that ends the search */
+float g_saturation_ratio = 0.95; /*					Runs accepting less than this fraction of their
+ *														 offered load are deemed saturated */
+int g_replications = 0; /*								Number of seeds the configuration is replicated with,
+ *														 to aggregate their results (0 = not in use) */
+vector<string> g_branch_variants; /*					Variants branched from the warmed-up network, each
+ *														 as 'key=value[;key=value...]' (empty if not in use) */
+vector<string> g_batch_axes; /*						Parameters whose combinations of values are simulated
+ *														 as a batch of runs (empty if not in use) */
+vector<vector<string> > g_batch_values; /*				Values taken by every batch axis */
+long long g_batch_memory_limit = 0; /*					Max address space of every batch run, in MB
+ *														 (0 = unlimited) */
 
 /* General variables */
 long long g_cycle = 0; /* 								Current cycle, tracks amount of simulated cycles */
@@ -118,6 +176,7 @@ generatorModule **g_generators_list; /* 				List of generator modules */
 switchModule **g_switches_list; /* 						List of router modules */
 int g_ports = g_p_computing_nodes_per_router + g_a_routers_per_group - 1 + g_h_global_ports_per_router; /*	Number of ports per router */
 default_random_engine g_reng;
+metricsSampler *g_metrics_sampler = NULL;
 
 /* Switch type */
 SwitchType g_switch_type = BASE_SW;
@@ -276,9 +335,10 @@ float *g_transient_record_injection_latency;
 long double *g_group0_totalLatency;
 long double *g_groupRoot_totalLatency;
 int g_latency_histogram_maxLat = 1;
-vector<long long> g_latency_histogram_no_global_misroute;
-vector<long long> g_latency_histogram_global_misroute_at_injection;
-vector<long long> g_latency_histogram_other_global_misroute;
+logHistogram * g_latency_histogram_no_global_misroute;
+logHistogram * g_latency_histogram_global_misroute_at_injection;
+logHistogram * g_latency_histogram_other_global_misroute;
+logHistogram * g_injection_latency_histogram;
 long long g_tx_flit_counter = 0;
 long long g_tx_cnmFlit_counter = 0;
 long long g_tx_flit_counter_printC = 0;
@@ -339,7 +399,7 @@ long long g_max_global_ring_hops = 0;
 long long g_max_local_tree_hops = 0;
 long long g_max_global_tree_hops = 0;
 int g_hops_histogram_maxHops = 200;
-long long * g_hops_histogram;
+logHistogram * g_hops_histogram;
 long long g_port_usage_counter[100];
 vector<vector<long long> > g_vc_counter;
 long long g_port_contention_counter[100];
@@ -375,21 +435,43 @@ long long g_max_dest_subnetwork_injections = 0;
 set<int> g_verbose_switches;
 int g_verbose_cycles = 5;
 
+/* Packet lifecycle tracing */
+bool g_packet_trace = false; /*							Record packet events (off by default) */
+int g_packet_trace_buffer_length = 4096; /*				Number of events kept per switch */
+set<long long> g_packet_trace_packets; /*				Packet ids to trace (all if empty) */
+set<int> g_packet_trace_groups; /*						Source groups to trace (all if empty) */
+set<int> g_packet_trace_switches; /*					Switches to trace (all if empty) */
+packetTracer *g_packet_tracer = NULL;
+
+/* Self-profiling */
+bool g_profile = false; /*								Time simulation phases (off by default) */
+phaseProfiler *g_profiler = NULL;
+
 /* Traces support */
 int g_num_traces = 0;
 vector<string> g_trace_file;
 vector<string> g_pcf_file;
-vector<vector<long> > g_event_deadlock;
+vector<vector<long long> > g_event_progress; /*		Last cycle each trace instance progressed (or is kept alive until) */
+long long g_event_deadlock_check = 0; /*			Next cycle an event deadlock may be detected at */
 vector<long> g_trace_nodes;
 vector<int> g_trace_instances;
 vector<vector<bool> > g_trace_ended;
 vector<vector<long> > g_trace_end_cycle;
+vector<vector<int> > g_trace_active_nodes; /*		Trace nodes with events left, per trace instance */
+vector<pair<int, int> > g_trace_drained; /*		Trace instances whose nodes have run out of events */
+int g_trace_instances_ended = 0; /*				Trace instances that have ended at least once */
 TraceAssignation g_trace_distribution = CONSECUTIVE;
+CollectiveAlgorithm g_collective_algorithm = LINEAR_COLL; /*	Expansion of MPI collectives into point-to-point messages */
 double g_cpu_speed = 1e9;
 long g_op_per_cycle = 50;
 long g_multitask = 1;
 long g_phit_size = 4; /* Phit size in bytes, for trace messages translation into simulator packets */
 bool g_cutmpi = 1;
 map<long, long> g_events_map;
-map<int, TraceNodeId> g_gen_2_trace_map;
-vector<vector<vector<int> > > g_trace_2_gen_map;
+vector<TraceNodeId> g_gen_2_trace_map; /*		Trace node (and instance) run by every generator; trace_id is -1 if none */
+vector<int> g_trace_2_gen_map; /*				Generator running every trace node instance, see traceNodeGenerator() */
+vector<int> g_trace_2_gen_offset; /*			First entry of every trace in g_trace_2_gen_map */
+vector<traceProgram*> g_trace_programs; /*			Compiled trace events, parsed once per trace */
+long g_trace_window = 0; /*							Events per task kept ahead when streaming binary traces (0 = map whole trace) */
+vector<tracePrefetcher*> g_trace_prefetchers;
+traceScheduler *g_trace_scheduler = NULL; /*			Runs trace generators only when they can progress */
@@ -27,6 +27,7 @@
 #include <map>
 #include <vector>
 #include <limits.h>
+#include <stdint.h>
 #include <random>
 #include <set>
 
@@ -34,9 +35,39 @@ using namespace std;
 
 class generatorModule;
 class switchModule;
+class logHistogram;
+class metricsSampler;
+class packetTracer;
+class phaseProfiler;
+class steadyStateDetector;
+class batchMeans;
+class traceProgram;
+class tracePrefetcher;
+class traceScheduler;
 
 #define DEBUG false
 
+/***
+ * Results format:
+ * -TEXT:			Human-readable report (default).
+ * -JSONL:			One machine-oriented JSON record per run, appended to
+ * 					 a JSON-lines file.
+ * -TEXT_JSONL:		Both of them.
+ */
+enum ResultsFormat {
+	TEXT, JSONL, TEXT_JSONL
+};
+
+/***
+ * Metrics whose confidence interval may end simulation:
+ * -FLIT_LATENCY:	Average flit latency.
+ * -PACKET_LATENCY:	Average packet latency.
+ * -ACCEPTED_LOAD:	Accepted load (phits/(node*cycle)).
+ */
+enum CIMetric {
+	FLIT_LATENCY, PACKET_LATENCY, ACCEPTED_LOAD
+};
+
 /***
  * General parameters
  */
@@ -44,8 +75,23 @@ extern long long g_max_cycles; /*						Maximum number of simulated cycles */
 extern long long g_warmup_cycles; /* 					Number of warm-up cycles; in those,
  *														 no general statistics are collected
  *														 (but some specific ones are) */
+extern long long g_steady_state_window; /*				Cycles per observation of the steady-state detector,
+ *														 which may end warmup earlier (0 = not in use) */
+extern steadyStateDetector *g_steady_state_detector; /*	Steady-state detector (NULL if not in use) */
+extern float g_ci_target; /*							Target relative half-width of the confidence intervals;
+ *														 simulation ends once reached (0 = not in use) */
+extern long long g_ci_batch_cycles; /*					Initial length of the batches employed to estimate them */
+extern vector<CIMetric> g_ci_metrics; /*				Metrics that must reach the target precision */
+extern batchMeans *g_batch_means; /*					Batch-means estimator (NULL if not in use) */
 extern int g_print_cycles; /*						Number of cycles between printing
  *														 temporary stats to the stdout. */
+extern bool g_print_progress; /*						Print temporary stats to the stdout or not */
+extern float g_print_interval; /*						Minimum wall-clock time (in seconds) between
+ *														 temporary stats prints; 0 disables rate limiting */
+extern long long g_sample_cycles; /*					Number of cycles between metrics samples; 0 disables
+ *														 the metrics time-series file */
+extern int g_sample_buffer_length; /*					Number of samples buffered before the background
+ *														 writer has to flush them */
 extern long long g_injection_queue_length; /* 			Injection queue size in phits */
 extern long long g_local_queue_length; /* 				Local link queue size in phits */
 extern long long g_global_queue_length; /* 				Global link queue size in phits */
@@ -83,6 +129,10 @@ extern float g_injection_probability; /* 				Packet injection probability at a g
  *														 injection rate within the network */
 extern char *g_output_file_name; /* 					Results filename */
 extern long long g_seed; /* 							Employed seed (to randomize simulations) */
+extern int32_t g_rand_state[32]; /*						State of rand(), kept here so it can be checkpointed */
+extern bool g_common_random_numbers; /*				Traffic of every generator is drawn from a stream of
+ *														 its own, so runs that only differ in routing or
+ *														 switch parameters share the same arrivals */
 extern int g_allocator_iterations; /* 					Number of (local/global) arbiter iterations
  *														 within an allocation cycle */
 extern int g_local_arbiter_speedup; /* 					SpeedUp within local arbiter: number of ports to
@@ -94,12 +144,64 @@ extern float g_internal_speedup; /*						SpeedUp in router frequency: router all
  *														 cycles are conducted faster and more frequently
  *														 than simulation cycles (only with InputOutputQueueing) */
 extern bool g_palm_tree_configuration;
+extern bool g_compact_tables; /*						Identical switch tables (routing, VC tables) are stored
+ *														 once and shared among switches */
+extern long long g_memory_budget; /*					Max projected memory footprint, in MB; simulation is
+ *														 aborted before building the network if exceeded
+ *														 (0 = unlimited) */
+/*
+ * Offset of a destination group among those directly linked to the source
+ * group, following the order of its global links. Tables indexed by this
+ * offset are the same for every switch at a given position within its group.
+ * Groups must differ; it is called on every routing decision, so it is not
+ * checked here.
+ */
+inline int groupOffset(int srcGroup, int destGroup) {
+	if (g_palm_tree_configuration)
+		return srcGroup - destGroup - 1
+				+ (srcGroup < destGroup ? g_a_routers_per_group * g_h_global_ports_per_router + 1 : 0);
+	return (destGroup > srcGroup) ? destGroup - 1 : destGroup;
+}
 extern bool g_transient_stats; /*						Determines if temporal statistics over simulation
  *														 time are tracked or not. Mainly related to transient
  *														 and trace traffic. */
 extern unsigned short g_cos_levels; /*					Number of Class of Service levels - Ethernet 802.1q */
 extern bool g_print_hists; /*							Chooses whether to print latency and injection
  *														 histograms or not. */
+extern ResultsFormat g_results_format; /*				Output format(s) of simulation results */
+extern char *g_results_file_name; /*					JSON-lines results filename (records are appended) */
+extern map<string, string> g_config_parameters; /*		Copy of the configuration parameters in use, to be
+ *														 stored along with the results */
+extern int g_histogram_precision; /*					Number of significant bits kept by latency and hop
+ *														 histograms (values below 2^precision are exact) */
+extern long long g_histogram_max_value; /*				Highest value tracked by histograms; larger ones
+ *														 are clamped into the last bucket */
+extern char *g_checkpoint_save_file; /*					Simulator state is stored here when warmup ends
+ *														 (NULL if not in use) */
+extern long long g_checkpoint_interval; /*				Cycles between checkpoints after warmup (0 = only
+ *														 the one at the end of warmup) */
+extern char *g_checkpoint_restore_file; /*				Simulation starts from the state stored in this file,
+ *														 instead of an empty network (NULL if not in use) */
+extern char *g_sweep_key; /*							Parameter swept over several values in a single
+ *														 invocation (NULL if not in use) */
+extern vector<string> g_sweep_values; /*				Values taken by the swept parameter, one per run */
+extern int g_sweep_jobs; /*								Max number of sweep runs simulated concurrently
+ *														 (0 = as many as available processors) */
+extern bool g_saturation_search; /*					Injection probability is swept looking for the
+ *														 saturation point, instead of taking fixed values */
+extern float g_saturation_tolerance; /*				Width (in probability points) of the bracket around
+ *														 the saturation point that ends the search */
+extern float g_saturation_ratio; /*					Runs accepting less than this fraction of their
+ *														 offered load are deemed saturated */
+extern int g_replications; /*							Number of seeds the configuration is replicated with,
+ *														 to aggregate their results (0 = not in use) */
+extern vector<string> g_branch_variants; /*			Variants branched from the warmed-up network, each
+ *														 as 'key=value[;key=value...]' (empty if not in use) */
+extern vector<string> g_batch_axes; /*					Parameters whose combinations of values are simulated
+ *														 as a batch of runs (empty if not in use) */
+extern vector<vector<string> > g_batch_values; /*		Values taken by every batch axis */
+extern long long g_batch_memory_limit; /*				Max address space of every batch run, in MB
+ *														 (0 = unlimited) */
 
 /***
  * General variables
@@ -130,6 +232,7 @@ extern generatorModule **g_generators_list; /* 			List of generator modules */
 extern switchModule **g_switches_list; /* 				List of router modules */
 extern int g_ports; /* 									Number of ports per router */
 extern default_random_engine g_reng; /*					Default random engine for any given distribution */
+extern metricsSampler *g_metrics_sampler; /*			Periodic metrics sampler (NULL if not in use) */
 
 enum PortType {
 	IN, OUT
@@ -807,9 +910,10 @@ extern long double *g_group0_totalLatency;	//Group 0, per switch average latency
 extern long double *g_groupRoot_totalLatency;	//Root group, per switch average latency
 //Latency histogram
 extern int g_latency_histogram_maxLat;
-extern vector<long long> g_latency_histogram_no_global_misroute;
-extern vector<long long> g_latency_histogram_global_misroute_at_injection;
-extern vector<long long> g_latency_histogram_other_global_misroute;
+extern logHistogram * g_latency_histogram_no_global_misroute;
+extern logHistogram * g_latency_histogram_global_misroute_at_injection;
+extern logHistogram * g_latency_histogram_other_global_misroute;
+extern logHistogram * g_injection_latency_histogram;
 
 /* Transmitted and received flits*/
 extern long long g_tx_flit_counter;
@@ -879,7 +983,7 @@ extern long long g_max_global_tree_hops;
 extern long long g_max_global_tree_hops;
 //Hops histogram
 extern int g_hops_histogram_maxHops;
-extern long long * g_hops_histogram;
+extern logHistogram * g_hops_histogram;
 
 /* Port and VC usage counters */
 extern long long g_port_usage_counter[];
@@ -920,21 +1024,41 @@ extern long long g_max_dest_subnetwork_injections;
 extern set<int> g_verbose_switches;
 extern int g_verbose_cycles;
 
+/* Packet lifecycle tracing */
+extern bool g_packet_trace; /*							Record packet events (off by default) */
+extern int g_packet_trace_buffer_length; /*				Number of events kept per switch */
+extern set<long long> g_packet_trace_packets; /*		Packet ids to trace (all if empty) */
+extern set<int> g_packet_trace_groups; /*				Source groups to trace (all if empty) */
+extern set<int> g_packet_trace_switches; /*				Switches to trace (all if empty) */
+extern packetTracer *g_packet_tracer;
+
+/* Self-profiling */
+extern bool g_profile; /*								Time simulation phases (off by default) */
+extern phaseProfiler *g_profiler;
+
 /*
  * Traces support
  */
 enum TraceAssignation {
 	CONSECUTIVE, INTERLEAVED, RANDOM
 };
+enum CollectiveAlgorithm {
+	LINEAR_COLL, BINOMIAL_COLL, RING_COLL, RDOUBLING_COLL
+};
 extern int g_num_traces;
 extern vector<string> g_trace_file; /*			Trace filename */
 extern vector<string> g_pcf_file; /*			PCF filename (used within traces support) */
-extern vector<vector<long> > g_event_deadlock;
+extern vector<vector<long long> > g_event_progress; /*	Last cycle each trace instance progressed (or is kept alive until) */
+extern long long g_event_deadlock_check; /*		Next cycle an event deadlock may be detected at */
 extern vector<long> g_trace_nodes;
 extern vector<int> g_trace_instances;
 extern vector<vector<bool> > g_trace_ended;
 extern vector<vector<long> > g_trace_end_cycle;
+extern vector<vector<int> > g_trace_active_nodes; /*	Trace nodes with events left, per trace instance */
+extern vector<pair<int, int> > g_trace_drained; /*	Trace instances whose nodes have run out of events */
+extern int g_trace_instances_ended; /*			Trace instances that have ended at least once */
 extern TraceAssignation g_trace_distribution;
+extern CollectiveAlgorithm g_collective_algorithm; /*	Expansion of MPI collectives into point-to-point messages */
 extern double g_cpu_speed;
 extern long g_op_per_cycle;
 extern long g_multitask;
@@ -942,10 +1066,19 @@ extern long g_phit_size;
 extern bool g_cutmpi;
 extern map<long, long> g_events_map;
 struct TraceNodeId {
-	int trace_id, trace_node;
+	int trace_id, trace_node, instance;
 };
-extern map<int, TraceNodeId> g_gen_2_trace_map;
-extern vector<vector<vector<int> > > g_trace_2_gen_map;
+extern vector<TraceNodeId> g_gen_2_trace_map; /*	Trace node (and instance) run by every generator; trace_id is -1 if none */
+extern vector<int> g_trace_2_gen_map; /*			Generator running every trace node instance, see traceNodeGenerator() */
+extern vector<int> g_trace_2_gen_offset; /*		First entry of every trace in g_trace_2_gen_map */
+/* Generator running a given instance of a trace node */
+inline int traceNodeGenerator(int trace, int node, int instance) {
+	return g_trace_2_gen_map[g_trace_2_gen_offset[trace] + instance * g_trace_nodes[trace] + node];
+}
+extern vector<traceProgram*> g_trace_programs; /*	Compiled trace events, parsed once per trace */
+extern long g_trace_window; /*						Events per task kept ahead when streaming binary traces (0 = map whole trace) */
+extern vector<tracePrefetcher*> g_trace_prefetchers;
+extern traceScheduler *g_trace_scheduler; /*			Runs trace generators only when they can progress */
 
 #endif	/* GLOBAL_H */
 
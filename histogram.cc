@@ -0,0 +1,145 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "histogram.h"
+#include "checkpoint.h"
+#include <math.h>
+#include <algorithm>
+
+logHistogram::logHistogram(int precisionBits, long long maxValue) :
+		m_precisionBits(precisionBits), m_maxValue(maxValue) {
+	assert(m_precisionBits >= 1 && m_precisionBits <= 24);
+	assert(m_maxValue >= 1);
+	m_subBucketCount = 1LL << m_precisionBits;
+	m_subBucketHalfCount = m_subBucketCount / 2;
+	m_numBuckets = getBucketIndex(m_maxValue) + 1;
+	m_counts = new long long[m_numBuckets];
+	reset();
+}
+
+logHistogram::~logHistogram() {
+	delete[] m_counts;
+}
+
+/*
+ * Returns the bucket that holds a given value. Values below
+ * 2^precisionBits map to themselves; otherwise, the value is
+ * shifted down until it fits into the upper half of the
+ * sub-bucket range, and the shift determines its magnitude.
+ */
+int logHistogram::getBucketIndex(long long value) const {
+	int magnitude;
+	assert(value >= 0);
+	if (value < m_subBucketCount) return value;
+	magnitude = (63 - __builtin_clzll(value)) - m_precisionBits + 1;
+	return m_subBucketCount + (magnitude - 1) * m_subBucketHalfCount + ((value >> magnitude) - m_subBucketHalfCount);
+}
+
+long long logHistogram::getBucketLowValue(int bucket) const {
+	int magnitude;
+	assert(bucket >= 0 && bucket < m_numBuckets);
+	if (bucket < m_subBucketCount) return bucket;
+	magnitude = (bucket - m_subBucketCount) / m_subBucketHalfCount + 1;
+	return (m_subBucketHalfCount + (bucket - m_subBucketCount) % m_subBucketHalfCount) << magnitude;
+}
+
+long long logHistogram::getBucketHighValue(int bucket) const {
+	if (bucket == m_numBuckets - 1) return m_maxValue;
+	return getBucketLowValue(bucket + 1) - 1;
+}
+
+void logHistogram::record(long long value, long long count) {
+	assert(value >= 0);
+	if (value < m_minRecorded || m_totalCount == 0) m_minRecorded = value;
+	if (value > m_maxRecorded) m_maxRecorded = value;
+	m_counts[getBucketIndex(value > m_maxValue ? m_maxValue : value)] += count;
+	m_totalCount += count;
+}
+
+void logHistogram::merge(const logHistogram& other) {
+	assert(m_precisionBits == other.m_precisionBits && m_numBuckets == other.m_numBuckets);
+	if (other.m_totalCount == 0) return;
+	for (int bucket = 0; bucket < m_numBuckets; bucket++)
+		m_counts[bucket] += other.m_counts[bucket];
+	if (m_totalCount == 0 || other.m_minRecorded < m_minRecorded) m_minRecorded = other.m_minRecorded;
+	if (other.m_maxRecorded > m_maxRecorded) m_maxRecorded = other.m_maxRecorded;
+	m_totalCount += other.m_totalCount;
+}
+
+void logHistogram::reset() {
+	for (int bucket = 0; bucket < m_numBuckets; bucket++)
+		m_counts[bucket] = 0;
+	m_totalCount = 0;
+	m_minRecorded = -1;
+	m_maxRecorded = -1;
+}
+
+long long logHistogram::getTotalCount() const {
+	return m_totalCount;
+}
+
+/* Returns -1 if no value has been recorded yet */
+long long logHistogram::getMinValue() const {
+	return m_minRecorded;
+}
+
+/* Returns -1 if no value has been recorded yet */
+long long logHistogram::getMaxValue() const {
+	return m_maxRecorded;
+}
+
+/*
+ * Returns the highest value equivalent (within histogram
+ * precision) to the one at the given percentile [0-100].
+ * Result is capped to the highest recorded value, so it
+ * is exact for the 100th percentile.
+ */
+long long logHistogram::getValueAtPercentile(double percentile) const {
+	long long target, accum = 0;
+	int bucket;
+
+	if (m_totalCount == 0) return -1;
+	if (percentile > 100) percentile = 100;
+	target = (long long) ceil(percentile / 100.0 * m_totalCount);
+	if (target < 1) target = 1;
+	for (bucket = 0; bucket < m_numBuckets; bucket++) {
+		accum += m_counts[bucket];
+		if (accum >= target) break;
+	}
+	assert(bucket < m_numBuckets);
+	return min(getBucketHighValue(bucket), m_maxRecorded);
+}
+
+int logHistogram::getNumBuckets() const {
+	return m_numBuckets;
+}
+
+long long logHistogram::getBucketCount(int bucket) const {
+	assert(bucket >= 0 && bucket < m_numBuckets);
+	return m_counts[bucket];
+}
+
+/* Bucket layout depends on the configuration, so only counts are stored */
+void logHistogram::checkpoint(checkpointFile &ckpt) {
+	ckpt.array(m_counts, m_numBuckets);
+	ckpt.value(m_totalCount);
+	ckpt.value(m_minRecorded);
+	ckpt.value(m_maxRecorded);
+}
@@ -0,0 +1,69 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef HISTOGRAM_H
+#define	HISTOGRAM_H
+
+#include "global.h"
+
+class checkpointFile;
+
+/*
+ * Fixed-footprint, log-bucketed (HDR-style) histogram. Values below
+ * 2^precisionBits are tracked exactly; above that, every power-of-two
+ * range is split into 2^(precisionBits-1) linear sub-buckets, so the
+ * relative error is bounded by 2^-(precisionBits-1). Memory is allocated
+ * once at construction and never grows, regardless of recorded values;
+ * values beyond maxValue are clamped into the last bucket (but the real
+ * maximum is still reported).
+ *
+ * Histograms with the same precision and range can be merged, e.g. to
+ * aggregate per-group or per-category instances before percentile queries.
+ */
+class logHistogram {
+public:
+	logHistogram(int precisionBits, long long maxValue);
+	virtual ~logHistogram();
+	void record(long long value, long long count = 1);
+	void merge(const logHistogram& other);
+	void reset();
+	long long getTotalCount() const;
+	long long getMinValue() const;
+	long long getMaxValue() const;
+	long long getValueAtPercentile(double percentile) const;
+	int getNumBuckets() const;
+	int getBucketIndex(long long value) const;
+	long long getBucketCount(int bucket) const;
+	long long getBucketLowValue(int bucket) const;
+	long long getBucketHighValue(int bucket) const;
+	void checkpoint(checkpointFile &ckpt);
+private:
+	int m_precisionBits;
+	long long m_subBucketCount; /* Number of exact values (2^precisionBits) */
+	long long m_subBucketHalfCount; /* Sub-buckets per power-of-two range above the exact ones */
+	long long m_maxValue; /* Highest trackable value; larger ones are clamped */
+	int m_numBuckets;
+	long long * m_counts;
+	long long m_totalCount;
+	long long m_minRecorded;
+	long long m_maxRecorded;
+};
+
+#endif	/* HISTOGRAM_H */
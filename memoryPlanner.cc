@@ -0,0 +1,359 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "memoryPlanner.h"
+#include "histogram.h"
+#include "switch/ioqSwitchModule.h"
+#include "switch/port/bufferedOutPort.h"
+#include "switch/port/dynBufBufferedOutPort.h"
+#include "switch/buffer/buffer.h"
+#include "switch/arbiter/cosArbiter.h"
+#include "switch/arbiter/rrArbiter.h"
+#include "switch/arbiter/priorityRrArbiter.h"
+#include "switch/arbiter/lrsArbiter.h"
+#include "switch/arbiter/priorityLrsArbiter.h"
+#include "switch/arbiter/ageArbiter.h"
+#include "switch/arbiter/priorityAgeArbiter.h"
+#include "generator/burstGenerator.h"
+#include "generator/traceGenerator.h"
+#include "generator/graph500Generator.h"
+#include <iomanip>
+#include <string.h>
+#include <unordered_map>
+
+enum MemorySubsystem {
+	MEM_SWITCHES, MEM_BUFFERS, MEM_FLITS, MEM_ARBITERS, MEM_ROUTING, MEM_VC, MEM_CONGESTION, MEM_GENERATORS,
+	MEM_STATISTICS, MEM_SUBSYSTEMS
+};
+
+static const char * SUBSYSTEM_NAMES[MEM_SUBSYSTEMS] = { "Switches", "Ports and buffers", "Flits (full buffers)",
+		"Arbiters", "Routing tables", "VC management", "Congestion state (CA/PB/QCN)", "Generators", "Statistics" };
+
+static const double MB = 1024.0 * 1024.0;
+
+/*
+ * Heap taken by an allocation of 'bytes', along with the chunk header and
+ * alignment added by the (glibc) allocator; most switch arrays are small
+ * enough for these to matter.
+ */
+static double heap(double bytes) {
+	long long chunk = ((long long) bytes + sizeof(size_t) + 15) & ~15LL;
+	return (chunk < 32) ? 32 : chunk;
+}
+
+/* Heap taken by an empty queue: libstdc++ deques allocate a map and a 512-byte node upon construction */
+static const double QUEUE_BYTES = heap(8 * sizeof(void *)) + heap(512);
+
+/*
+ * Heap taken by a buffer of 'capacity' phits.
+ */
+static double bufferBytes(long long capacity) {
+	long long slots = capacity / g_flit_size + 1;
+	return heap(sizeof(buffer)) + heap(slots * sizeof(float)) + heap(slots * sizeof(flitModule *));
+}
+
+/*
+ * Heap taken by the buffers of a port, given the number of cos levels
+ * and VCs they are allocated for.
+ */
+static double bufferedPortBytes(int cosLevels, int numVCs, long long capacity) {
+	return heap(cosLevels * sizeof(buffer **))
+			+ cosLevels * (heap(numVCs * sizeof(buffer *)) + numVCs * bufferBytes(capacity));
+}
+
+/*
+ * Projects an input port with 'channels' VCs of 'queueLength' phits, and
+ * the flits its buffers can store. Every port allocates one buffer per cos
+ * level and VC in use anywhere in the switch; dynamic buffers are sized
+ * to hold the whole shared pool.
+ */
+static void planInPort(int channels, long long queueLength, int reserved, bool dynamic, double bytes[]) {
+	int numVCs = g_local_link_channels + g_global_link_channels;
+	int usedVCs = (g_vc_usage == BASE) ? channels : numVCs;
+	long long capacity, aggregated;
+
+	if (dynamic) {
+		capacity = queueLength / g_cos_levels / channels;
+		aggregated = numVCs * (capacity / g_flit_size - reserved);
+		bytes[MEM_BUFFERS] += heap(sizeof(dynamicBufferInPort))
+				+ bufferedPortBytes(g_cos_levels, numVCs, (aggregated + reserved) * g_flit_size);
+		bytes[MEM_FLITS] += g_cos_levels * (aggregated + numVCs * reserved) * heap(sizeof(flitModule));
+	} else {
+		bytes[MEM_BUFFERS] += heap(sizeof(inPort)) + bufferedPortBytes(g_cos_levels, numVCs, queueLength);
+		bytes[MEM_FLITS] += g_cos_levels * usedVCs * (queueLength / g_flit_size) * heap(sizeof(flitModule));
+	}
+}
+
+/*
+ * Projects an output port with 'channels' VCs, along with its output
+ * buffers in input-output queued switches.
+ */
+static void planOutPort(int channels, bool segregated, bool dynamic, double bytes[]) {
+	int numVCs = g_local_link_channels + g_global_link_channels;
+	int outVCs = (g_vc_usage == BASE) ? channels : numVCs;
+	int flows = segregated ? g_segregated_flows : 1;
+
+	/* Credit trackers */
+	bytes[MEM_BUFFERS] += 3 * (heap(g_cos_levels * sizeof(int *)) + g_cos_levels * heap(outVCs * sizeof(int)));
+	if (g_switch_type != IOQ_SW) {
+		bytes[MEM_BUFFERS] += heap(dynamic ? sizeof(dynamicBufferOutPort) : sizeof(outPort));
+		return;
+	}
+	bytes[MEM_BUFFERS] += heap(dynamic ? sizeof(dynamicBufferBufferedOutPort) : sizeof(bufferedOutPort));
+	bytes[MEM_BUFFERS] += 3 * (heap(g_cos_levels * sizeof(int **))
+			+ g_cos_levels * (heap(outVCs * sizeof(int *)) + outVCs * heap(flows * sizeof(int))));
+	bytes[MEM_BUFFERS] += bufferedPortBytes(1, numVCs, g_out_queue_length);
+	bytes[MEM_FLITS] += numVCs * (g_out_queue_length / g_flit_size) * heap(sizeof(flitModule));
+}
+
+/*
+ * Heap taken by an arbitration protocol among 'ports' contenders.
+ */
+static double arbiterBytes(ArbiterType type, int ports) {
+	double lists = heap(ports * sizeof(int)) + heap(ports * sizeof(short)); /* Port order, set by the base arbiter */
+	switch (type) {
+		case RR: /* Round-robin arbiters set their own (rotated) port order */
+			return heap(sizeof(rrArbiter)) + 2 * lists;
+		case PrioRR:
+			return heap(sizeof(priorityRrArbiter)) + 2 * lists;
+		case LRS:
+			return heap(sizeof(lrsArbiter)) + lists;
+		case PrioLRS:
+			return heap(sizeof(priorityLrsArbiter)) + lists;
+		case AGE:
+			return heap(sizeof(ageArbiter)) + lists + heap(ports * sizeof(float));
+		case PrioAGE:
+			return heap(sizeof(priorityAgeArbiter)) + lists + heap(ports * sizeof(float));
+	}
+	return lists;
+}
+
+void planMemory() {
+	double bytes[MEM_SUBSYSTEMS] = { 0 }, total = 0, perSwitch[MEM_SUBSYSTEMS] = { 0 };
+	long long switches = g_number_switches;
+	int groups = g_a_routers_per_group * g_h_global_ports_per_router + 1;
+	int p, s, routings, vcTables = 0;
+	bool qcn = (g_congestion_management == QCNSW);
+	bool dynamic = (g_buffer_type == DYNAMIC);
+	int inPorts = qcn ? g_ports + 1 : g_ports; /* QCN notifications are injected through an additional port */
+
+	cout << "switchModule size: " << sizeof(switchModule) << endl;
+	cout << "generatorModule size: " << sizeof(generatorModule) << endl;
+
+	/* Switch modules and their state arrays */
+	perSwitch[MEM_SWITCHES] = heap((g_switch_type == IOQ_SW) ? sizeof(ioqSwitchModule) : sizeof(switchModule));
+	perSwitch[MEM_SWITCHES] += 2 * heap(inPorts * sizeof(void *)) + 2 * heap(g_ports * sizeof(void *));
+	perSwitch[MEM_SWITCHES] += heap(inPorts * g_channels * sizeof(float)) + 5 * heap(g_channels * sizeof(float));
+	perSwitch[MEM_SWITCHES] += heap(g_ports * sizeof(bool)) + heap(g_cos_levels * sizeof(bool *))
+			+ g_cos_levels * heap(g_channels * sizeof(bool));
+	perSwitch[MEM_SWITCHES] += heap(g_ports * sizeof(queue<creditFlit> *))
+			+ g_ports * (heap(sizeof(queue<creditFlit>)) + QUEUE_BYTES);
+	perSwitch[MEM_SWITCHES] += 2 * QUEUE_BYTES; /* Piggybacking and contention notification queues */
+	if (g_switch_type == IOQ_SW) perSwitch[MEM_SWITCHES] += heap(g_ports * sizeof(int));
+
+	/* Ports, along with the flits their buffers can store */
+	for (p = 0; p < g_p_computing_nodes_per_router; p++) {
+		planInPort(g_injection_channels, g_injection_queue_length, 0, false, perSwitch);
+		planOutPort(g_injection_channels, true, false, perSwitch);
+	}
+	for (p = g_local_router_links_offset; p < g_global_router_links_offset; p++) {
+		planInPort(g_local_link_channels, g_local_queue_length, g_local_queue_reserved, dynamic, perSwitch);
+		planOutPort(g_local_link_channels, false, dynamic, perSwitch);
+	}
+	for (p = g_global_router_links_offset; p < g_global_router_links_offset + g_h_global_ports_per_router; p++) {
+		planInPort(g_global_link_channels, g_global_queue_length, g_global_queue_reserved, dynamic, perSwitch);
+		planOutPort(g_global_link_channels, false, dynamic, perSwitch);
+	}
+	if (qcn) planInPort(g_injection_channels, g_qcn_queue_length, 0, false, perSwitch);
+
+	/* Arbiters: one input arbiter per cos level and input port, one output arbiter per output port */
+	perSwitch[MEM_ARBITERS] = inPorts * (heap(sizeof(inputArbiter)) + heap(g_cos_levels * sizeof(cosArbiter *))
+			+ g_cos_levels * (heap(sizeof(cosArbiter)) + arbiterBytes(g_input_arbiter_type, g_channels)));
+	perSwitch[MEM_ARBITERS] += g_ports * (heap(sizeof(outputArbiter)) + 4 * heap(inPorts * sizeof(int))
+			+ heap(inPorts * sizeof(unsigned short)) + arbiterBytes(g_output_arbiter_type, inPorts));
+
+	/* Routing tables; QCN switches route their notifications with an additional minimal routing */
+	routings = qcn ? 2 : 1;
+	perSwitch[MEM_ROUTING] = heap(sizeof(baseRouting)) + heap(g_ports * sizeof(switchModule *));
+	if (g_deadlock_avoidance == RING || g_deadlock_avoidance == EMBEDDED_RING)
+		perSwitch[MEM_ROUTING] += 4 * heap(switches * sizeof(int));
+	else if (g_deadlock_avoidance == EMBEDDED_TREE)
+		perSwitch[MEM_ROUTING] += 2 * heap(switches * sizeof(int));
+	if (g_misrouting_trigger == CGA || g_misrouting_trigger == HYBRID || g_misrouting_trigger == HYBRID_REMOTE)
+		perSwitch[MEM_ROUTING] += heap(g_channels * sizeof(bool **)) + g_channels
+				* (heap(g_cos_levels * sizeof(bool *)) + g_cos_levels * heap(g_h_global_ports_per_router));
+	perSwitch[MEM_ROUTING] *= routings;
+
+	/* VC management: its VC arrays hold at most one entry per VC, and table-based FlexVC adds VC tables
+	 * per destination group */
+	switch (g_vc_usage) {
+		case TBFLEX:
+			vcTables = g_reactive_traffic ? 4 : 2;
+			perSwitch[MEM_VC] = heap(sizeof(tbFlexVc));
+			break;
+		case FLEXIBLE:
+			perSwitch[MEM_VC] = heap(sizeof(flexVc));
+			break;
+		default:
+			perSwitch[MEM_VC] = heap(sizeof(vcMngmt));
+			break;
+	}
+	perSwitch[MEM_VC] += 11 * heap(g_channels * sizeof(int));
+	perSwitch[MEM_VC] *= routings;
+
+	/* Contention counters and queues, piggybacked global link state, and QCN congestion and reaction point
+	 * arrays */
+	perSwitch[MEM_CONGESTION] = 3 * heap(g_ports * sizeof(int)) + heap(g_a_routers_per_group * sizeof(int *))
+			+ g_a_routers_per_group * heap(groups * sizeof(int));
+	perSwitch[MEM_CONGESTION] += heap(g_ports * sizeof(queue<float>) + sizeof(size_t))
+			+ heap(groups * sizeof(queue<float>) + sizeof(size_t)) + (g_ports + groups) * QUEUE_BYTES;
+	perSwitch[MEM_CONGESTION] += heap(g_global_links_per_group * sizeof(bool **)) + g_global_links_per_group
+			* (heap(g_cos_levels * sizeof(bool *)) + g_cos_levels * heap(g_global_link_channels * sizeof(bool)));
+	if (qcn) perSwitch[MEM_CONGESTION] += 5 * heap(g_ports * sizeof(int));
+
+	for (s = 0; s < MEM_SUBSYSTEMS; s++)
+		bytes[s] = perSwitch[s] * switches;
+
+	/* Tables indexed by the router within the destination group, or by the offset of the destination group,
+	 * are the same for every switch at the same position within its group, and in compact mode they are
+	 * stored once per position */
+	bytes[MEM_ROUTING] += (g_compact_tables ? g_a_routers_per_group : routings * switches)
+			* (heap(g_a_routers_per_group * sizeof(int)) + heap((groups - 1) * sizeof(int)));
+	/* So are neighbor ports under a palm tree arrangement */
+	bytes[MEM_ROUTING] += heap(g_ports * sizeof(int))
+			* ((g_compact_tables && g_palm_tree_configuration) ? g_a_routers_per_group : routings * switches);
+	/* VC tables per destination router do not even depend on the position of the switch */
+	if (g_vc_usage == TBFLEX)
+		bytes[MEM_VC] += vcTables
+				* ((g_compact_tables ? 1 : routings * switches) * heap(g_a_routers_per_group * sizeof(short))
+						+ (g_compact_tables ? g_a_routers_per_group : routings * switches)
+								* heap((groups - 1) * sizeof(short)));
+
+	/* Generators, along with their traffic pattern */
+	switch (g_traffic) {
+		case TRACE:
+			bytes[MEM_GENERATORS] = heap(sizeof(traceGenerator));
+			break;
+		case BURSTY_UN:
+			bytes[MEM_GENERATORS] = heap(sizeof(burstGenerator));
+			break;
+		case GRAPH500:
+			bytes[MEM_GENERATORS] = heap(sizeof(graph500Generator));
+			break;
+		default:
+			bytes[MEM_GENERATORS] = heap(sizeof(generatorModule));
+			break;
+	}
+	bytes[MEM_GENERATORS] += sizeof(generatorModule *) + heap(max(sizeof(mixTraffic), sizeof(transientTraffic)))
+			+ 2 * heap(g_injection_channels * sizeof(int));
+	bytes[MEM_GENERATORS] *= g_number_generators;
+
+	/* Latency and hop histograms, group statistics and transient records */
+	logHistogram histogram(g_histogram_precision, g_histogram_max_value);
+	bytes[MEM_STATISTICS] = 5 * (heap(sizeof(logHistogram)) + heap(histogram.getNumBuckets() * sizeof(long long)));
+	bytes[MEM_STATISTICS] += g_a_routers_per_group
+			* (g_p_computing_nodes_per_router * (sizeof(long long *) + heap(2 * sizeof(long long)))
+					+ 2 * (sizeof(long double) + sizeof(long long)));
+	if (g_routing == ACOR || g_routing == PB_ACOR)
+		bytes[MEM_STATISTICS] += g_a_routers_per_group * heap((g_max_cycles + g_warmup_cycles) * sizeof(int))
+				* ((g_acor_state_management == SWITCHCGCSRS || g_acor_state_management == SWITCHCGRS
+						|| g_acor_state_management == SWITCHCSRS) ? 2 : 1);
+	if (g_transient_stats) bytes[MEM_STATISTICS] += 8 * heap(g_transient_record_len * sizeof(float));
+
+	cout << "Projected memory footprint" << (g_compact_tables ? " (compact tables)" : "") << ":" << endl;
+	ios::fmtflags flags = cout.flags();
+	streamsize precision = cout.precision();
+	cout << fixed << setprecision(2);
+	for (s = 0; s < MEM_SUBSYSTEMS; s++) {
+		total += bytes[s];
+		cout << "    " << SUBSYSTEM_NAMES[s] << ": " << bytes[s] / MB << " MB" << endl;
+	}
+	cout << "    Total: " << total / MB << " MB" << endl;
+	cout.flags(flags);
+	cout.precision(precision);
+
+	if (g_memory_budget > 0 && total > g_memory_budget * MB) {
+		cerr << "ERROR: projected memory footprint (" << (long long) (total / MB) << " MB) exceeds MemoryBudget ("
+				<< g_memory_budget << " MB)" << endl;
+		exit(-1);
+	}
+}
+
+struct pooledTable {
+	const void *table;
+	size_t bytes;
+	void (*release)(const void *);
+};
+
+static unordered_multimap<size_t, pooledTable> tablePool;
+static long long pooledRequests = 0;
+static double requestedBytes = 0, pooledBytes = 0;
+
+/*
+ * FNV-1a hash of the contents of a table.
+ */
+static size_t hashTable(const void *table, size_t bytes) {
+	const unsigned char *data = (const unsigned char *) table;
+	size_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < bytes; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/*
+ * Looks up a table in the pool, returning the pooled copy (and releasing
+ * the one given) if an identical table was pooled before, or pooling the
+ * given one otherwise.
+ */
+const void * poolTable(const void *table, size_t bytes, void (*release)(const void *)) {
+	if (table == NULL) return NULL;
+	size_t hash = hashTable(table, bytes);
+	pair<unordered_multimap<size_t, pooledTable>::iterator, unordered_multimap<size_t, pooledTable>::iterator> range =
+			tablePool.equal_range(hash);
+	unordered_multimap<size_t, pooledTable>::iterator it;
+
+	pooledRequests++;
+	requestedBytes += bytes;
+	for (it = range.first; it != range.second; ++it) {
+		if (it->second.bytes == bytes && it->second.release == release
+				&& memcmp(it->second.table, table, bytes) == 0) {
+			release(table);
+			return it->second.table;
+		}
+	}
+	pooledTable pooled = { table, bytes, release };
+	tablePool.insert(make_pair(hash, pooled));
+	pooledBytes += bytes;
+	return table;
+}
+
+void reportSharedTables() {
+	cout << "Shared tables: " << pooledRequests << " switch tables stored as " << tablePool.size() << " ("
+			<< (long long) ((requestedBytes - pooledBytes) / 1024) << " KB saved)" << endl;
+}
+
+void freeSharedTables() {
+	unordered_multimap<size_t, pooledTable>::iterator it;
+	for (it = tablePool.begin(); it != tablePool.end(); ++it)
+		it->second.release(it->second.table);
+	tablePool.clear();
+}
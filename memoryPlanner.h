@@ -0,0 +1,60 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MEMORYPLANNER_H
+#define	MEMORYPLANNER_H
+
+#include "global.h"
+
+/*
+ * Memory-footprint planner. Before the network is built, the memory
+ * every subsystem will take is projected from the configuration, upon
+ * the same sizes the constructors allocate, and reported. If a budget
+ * is set and the projection exceeds it, simulation is aborted before
+ * any allocation.
+ */
+void planMemory();
+
+/*
+ * Pool of tables shared among switches in compact mode. Every switch
+ * builds its tables as usual, and then looks them up by content: if an
+ * identical one is already pooled, its own copy is released and the
+ * pooled one is employed instead. Pooled tables must not be modified,
+ * and they are freed along with the pool.
+ */
+const void * poolTable(const void *table, size_t bytes, void (*release)(const void *));
+void reportSharedTables();
+void freeSharedTables();
+
+template<class T> void releaseTableArray(const void *table) {
+	delete[] (const T *) table;
+}
+
+template<class T> T * shareTable(T *table, int length) {
+	if (!g_compact_tables) return table;
+	return (T *) poolTable(table, length * sizeof(T), releaseTableArray<T>);
+}
+
+/* Tables passed through shareTable() are owned by the pool in compact mode */
+template<class T> void releaseTable(T *table) {
+	if (!g_compact_tables) delete[] table;
+}
+
+#endif	/* MEMORYPLANNER_H */
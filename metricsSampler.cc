@@ -0,0 +1,128 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "metricsSampler.h"
+#include "switch/switchModule.h"
+#include <iostream>
+
+metricsSampler::metricsSampler(const char * file_name, long long interval, int capacity) :
+		m_interval(interval), m_capacity(capacity) {
+	int group;
+
+	assert(m_interval > 0);
+	assert(m_capacity > 0);
+	m_outputFile.open(file_name, ios::out);
+	if (!m_outputFile) {
+		cerr << "Can't open the metrics output file " << file_name << endl;
+		exit(-1);
+	}
+	m_numGroups = g_number_switches / g_a_routers_per_group;
+	m_width = 8 + m_numGroups;
+	m_ring = new long long[(long long) m_capacity * m_width];
+	m_head = 0;
+	m_tail = 0;
+	m_nextSampleCycle = 0;
+	m_closing = false;
+
+	m_outputFile << "cycle,tx_flits,rx_flits,tx_packets,rx_packets,tx_cnm_flits,rx_cnm_flits,queued_phits";
+	for (group = 0; group < m_numGroups; group++)
+		m_outputFile << ",group" << group << "_packets_injected";
+	m_outputFile << endl;
+
+	m_writer = thread(&metricsSampler::writerLoop, this);
+}
+
+metricsSampler::~metricsSampler() {
+	close();
+	delete[] m_ring;
+}
+
+/*
+ * Captures current counter values into the next ring slot.
+ * Only blocks if the ring is full (writer lagging behind).
+ */
+void metricsSampler::sample() {
+	long long * row;
+	int i, v;
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_cond.wait(lock, [this] {return m_head - m_tail < m_capacity;});
+	}
+	row = &m_ring[(m_head % m_capacity) * m_width];
+	row[0] = g_cycle;
+	row[1] = g_tx_flit_counter;
+	row[2] = g_rx_flit_counter;
+	row[3] = g_tx_packet_counter;
+	row[4] = g_rx_packet_counter;
+	row[5] = g_tx_cnmFlit_counter;
+	row[6] = g_rx_cnmFlit_counter;
+	row[7] = 0;
+	for (v = 8; v < m_width; v++)
+		row[v] = 0;
+	for (i = 0; i < g_number_switches; i++) {
+		row[7] += g_switches_list[i]->getTotalOccupancy();
+		row[8 + g_switches_list[i]->hPos] += g_switches_list[i]->packetsInj;
+	}
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_head++;
+	}
+	m_cond.notify_all();
+
+	/* Cycles may be skipped (e.g., trace computation events); align to next interval */
+	m_nextSampleCycle = (g_cycle / m_interval + 1) * m_interval;
+}
+
+void metricsSampler::writerLoop() {
+	long long * row;
+	int v;
+
+	unique_lock<mutex> lock(m_mutex);
+	while (true) {
+		m_cond.wait(lock, [this] {return m_tail < m_head || m_closing;});
+		if (m_tail == m_head && m_closing) break;
+		/* Rows between tail and head are owned by the writer: format them without the lock */
+		while (m_tail < m_head) {
+			row = &m_ring[(m_tail % m_capacity) * m_width];
+			lock.unlock();
+			m_outputFile << row[0];
+			for (v = 1; v < m_width; v++)
+				m_outputFile << "," << row[v];
+			m_outputFile << "\n";
+			lock.lock();
+			m_tail++;
+			m_cond.notify_all();
+		}
+	}
+	m_outputFile.flush();
+}
+
+/* Flushes pending samples and stops the writer thread */
+void metricsSampler::close() {
+	if (!m_writer.joinable()) return;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_closing = true;
+	}
+	m_cond.notify_all();
+	m_writer.join();
+	m_outputFile.close();
+}
@@ -0,0 +1,64 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef METRICSSAMPLER_H
+#define	METRICSSAMPLER_H
+
+#include "global.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*
+ * Periodic metrics sampler. Every 'interval' cycles, a row of
+ * cumulative counters (tx/rx flits and packets, CNMs, phits stored
+ * in switch buffers and per-group packet injections) is captured into
+ * a preallocated ring. A background thread drains the ring into a CSV
+ * time-series file, so the simulation loop never formats output; if
+ * the ring fills up, the simulation waits for the writer to catch up.
+ */
+class metricsSampler {
+public:
+	metricsSampler(const char * file_name, long long interval, int capacity);
+	virtual ~metricsSampler();
+	/* Cheap check to be done every cycle */
+	inline bool isSampleDue() const {
+		return g_cycle >= m_nextSampleCycle;
+	}
+	void sample();
+	void close();
+private:
+	ofstream m_outputFile;
+	long long m_interval;
+	long long m_nextSampleCycle;
+	int m_capacity; /* Ring size, in samples */
+	int m_width; /* Values per sample */
+	int m_numGroups;
+	long long * m_ring;
+	long long m_head; /* Total samples written by the simulator */
+	long long m_tail; /* Total samples flushed by the writer */
+	bool m_closing;
+	mutex m_mutex;
+	condition_variable m_cond;
+	thread m_writer;
+	void writerLoop();
+};
+
+#endif	/* METRICSSAMPLER_H */
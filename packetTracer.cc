@@ -0,0 +1,129 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "packetTracer.h"
+#include "flit/flitModule.h"
+#include <iostream>
+#include <algorithm>
+
+packetTracer::packetTracer(int numSwitches, int capacity) :
+		m_numSwitches(numSwitches), m_capacity(capacity) {
+	assert(m_capacity > 0);
+	m_rings = new packetEvent*[m_numSwitches];
+	m_counts = new long long[m_numSwitches];
+	for (int sw = 0; sw < m_numSwitches; sw++) {
+		m_rings[sw] = new packetEvent[m_capacity];
+		m_counts[sw] = 0;
+	}
+}
+
+packetTracer::~packetTracer() {
+	for (int sw = 0; sw < m_numSwitches; sw++)
+		delete[] m_rings[sw];
+	delete[] m_rings;
+	delete[] m_counts;
+}
+
+void packetTracer::record(PacketEventType type, int sw, const flitModule * flit, int inPort, int inVC, int outPort,
+		int outVC) {
+	packetEvent * ev;
+
+	assert(sw >= 0 && sw < m_numSwitches);
+	if (!g_packet_trace_packets.empty() && g_packet_trace_packets.count(flit->packetId) == 0) return;
+	if (!g_packet_trace_groups.empty() && g_packet_trace_groups.count(flit->sourceGroup) == 0) return;
+	if (!g_packet_trace_switches.empty() && g_packet_trace_switches.count(sw) == 0) return;
+
+	ev = &m_rings[sw][m_counts[sw] % m_capacity];
+	ev->cycle = g_internal_cycle;
+	ev->packetId = flit->packetId;
+	ev->flitId = flit->flitId;
+	ev->sw = sw;
+	ev->inPort = inPort;
+	ev->inVC = inVC;
+	ev->outPort = outPort;
+	ev->outVC = outVC;
+	ev->type = type;
+	m_counts[sw]++;
+}
+
+const char * packetTracer::eventName(PacketEventType type) {
+	switch (type) {
+		case PKT_INJECT:
+			return "inject";
+		case PKT_ROUTE:
+			return "route";
+		case PKT_VC_ALLOC:
+			return "vc_alloc";
+		case PKT_XBAR:
+			return "xbar";
+		case PKT_CONSUME:
+			return "consume";
+	}
+	return "unknown";
+}
+
+static bool packetEventOrder(const packetEvent& a, const packetEvent& b) {
+	if (a.packetId != b.packetId) return a.packetId < b.packetId;
+	return a.cycle < b.cycle;
+}
+
+void packetTracer::exportChromeTrace(const char * file_name) {
+	ofstream outputFile;
+	vector<packetEvent> events;
+	long long i, first;
+	int sw;
+	const char * flow_phase;
+
+	outputFile.open(file_name, ios::out);
+	if (!outputFile) {
+		cerr << "Can't open the packet trace output file" << endl;
+		exit(-1);
+	}
+
+	/* Gather surviving events of every ring, in recording order */
+	for (sw = 0; sw < m_numSwitches; sw++) {
+		first = max(0LL, m_counts[sw] - m_capacity);
+		for (i = first; i < m_counts[sw]; i++)
+			events.push_back(m_rings[sw][i % m_capacity]);
+	}
+	stable_sort(events.begin(), events.end(), packetEventOrder);
+
+	/* Timestamps are given in cycles (shown as microseconds by trace viewers) */
+	outputFile << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+	for (i = 0; i < (long long) events.size(); i++) {
+		packetEvent& ev = events[i];
+		if (i > 0) outputFile << "," << endl;
+		outputFile << "{\"name\":\"" << eventName(ev.type) << "\",\"cat\":\"packet\",\"ph\":\"X\",\"ts\":" << ev.cycle
+				<< ",\"dur\":1,\"pid\":" << ev.sw << ",\"tid\":" << ev.inPort << ",\"args\":{\"packet\":"
+				<< ev.packetId << ",\"flit\":" << ev.flitId << ",\"in_port\":" << ev.inPort << ",\"in_vc\":"
+				<< ev.inVC << ",\"out_port\":" << ev.outPort << ",\"out_vc\":" << ev.outVC << "}}";
+
+		/* Flow events link consecutive events of the same packet */
+		bool first_of_packet = (i == 0 || events[i - 1].packetId != ev.packetId);
+		bool last_of_packet = (i + 1 == (long long) events.size() || events[i + 1].packetId != ev.packetId);
+		if (first_of_packet && last_of_packet) continue;
+		flow_phase = first_of_packet ? "s" : (last_of_packet ? "f" : "t");
+		outputFile << "," << endl << "{\"name\":\"packet\",\"cat\":\"flow\",\"ph\":\"" << flow_phase
+				<< "\",\"bp\":\"e\",\"id\":" << ev.packetId << ",\"ts\":" << ev.cycle << ",\"pid\":" << ev.sw
+				<< ",\"tid\":" << ev.inPort << "}";
+	}
+	outputFile << endl << "]}" << endl;
+	outputFile.close();
+}
@@ -0,0 +1,77 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PACKETTRACER_H
+#define	PACKETTRACER_H
+
+#include "global.h"
+
+class flitModule;
+
+/*
+ * Packet lifecycle events:
+ * -INJECT:		flit is inserted into an injection queue.
+ * -ROUTE:		routing decision for a head flit (may repeat while
+ * 				 the petition can not be made).
+ * -VC_ALLOC:	petition made to an output port and VC.
+ * -XBAR:		flit traverses the crossbar.
+ * -CONSUME:	flit is consumed at its destination node.
+ */
+enum PacketEventType {
+	PKT_INJECT, PKT_ROUTE, PKT_VC_ALLOC, PKT_XBAR, PKT_CONSUME
+};
+
+struct packetEvent {
+	double cycle;
+	long long packetId;
+	long long flitId;
+	int sw;
+	short inPort, inVC, outPort, outVC;
+	PacketEventType type;
+};
+
+/*
+ * Packet event tracer. Every switch owns a fixed-size binary ring of
+ * events (oldest ones are overwritten when full), so tracing long runs
+ * keeps the most recent history. Traced packets can be restricted to a
+ * set of packet ids, source groups and/or switches (g_packet_trace_*);
+ * an empty set does not filter. Callers guard every hook with 'if (g_packet_trace)', so the
+ * tracer costs a single branch when disabled.
+ *
+ * At the end of the simulation, events are exported in Chrome trace
+ * (JSON) format, loadable by chrome://tracing or Perfetto: every switch
+ * is a process, every input port a thread, and the events of each
+ * packet are linked by flow arrows.
+ */
+class packetTracer {
+public:
+	packetTracer(int numSwitches, int capacity);
+	virtual ~packetTracer();
+	void record(PacketEventType type, int sw, const flitModule * flit, int inPort, int inVC, int outPort, int outVC);
+	void exportChromeTrace(const char * file_name);
+private:
+	int m_numSwitches;
+	int m_capacity;
+	packetEvent ** m_rings;
+	long long * m_counts; /* Total events recorded per switch */
+	static const char * eventName(PacketEventType type);
+};
+
+#endif	/* PACKETTRACER_H */
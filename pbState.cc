@@ -19,6 +19,7 @@
  */
 
 #include "pbState.h"
+#include "checkpoint.h"
 
 pbState::pbState(int switchApos) :
 		m_switchApos(switchApos) {
@@ -114,3 +115,9 @@ int groupGlobalLinkID2port(int id, int switchApos) {
 
 	return id - switchApos * g_h_global_ports_per_router + g_global_router_links_offset;
 }
+
+void pbState::checkpoint(checkpointFile &ckpt) {
+	for (int link = 0; link < g_global_links_per_group; link++)
+		for (int cos = 0; cos < g_cos_levels; cos++)
+			ckpt.array(m_globalLinkCongested[link][cos], g_global_link_channels);
+}
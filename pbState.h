@@ -36,6 +36,7 @@ public:
 	pbFlit* createFlit(int latency);
 	void update(int port, unsigned short cos, int channel, bool linkCongested);
 	bool isCongested(int link, unsigned short cos, int channel);
+	void checkpoint(checkpointFile &ckpt);
 private:
 	int m_switchApos;
 	bool*** m_globalLinkCongested;
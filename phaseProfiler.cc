@@ -0,0 +1,95 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "phaseProfiler.h"
+#include <iomanip>
+
+phaseProfiler::phaseProfiler() {
+	for (int phase = 0; phase < PROF_NUM_PHASES; phase++) {
+		m_time[phase] = 0;
+		m_calls[phase] = 0;
+	}
+	m_runStart = 0;
+	m_runTime = 0;
+}
+
+phaseProfiler::~phaseProfiler() {
+}
+
+void phaseProfiler::startRun() {
+	m_runStart = now();
+}
+
+void phaseProfiler::endRun() {
+	m_runTime = now() - m_runStart;
+}
+
+const char * phaseProfiler::phaseName(ProfilePhase phase) {
+	switch (phase) {
+		case PROF_CREDITS:
+			return "updateCredits";
+		case PROF_PIGGYBACKING:
+			return "updatePb";
+		case PROF_CONTENTION:
+			return "caHandler::update";
+		case PROF_INPUT_ARBITRATION:
+			return "input arbitration";
+		case PROF_ROUTING:
+			return "  routing (in input arb.)";
+		case PROF_OUTPUT_ARBITRATION:
+			return "output arbitration";
+		case PROF_XBAR:
+			return "xbarTraversal";
+		case PROF_OUTPUT_BUFFER:
+			return "updateOutputBuffer";
+		case PROF_GENERATORS:
+			return "generators";
+		default:
+			return "unknown";
+	}
+}
+
+/*
+ * Reports simulation speed and the breakdown of run time per phase.
+ * Time not covered by any phase (main loop bookkeeping, trace handling,
+ * statistics) is reported as 'other'.
+ */
+void phaseProfiler::writeReport(ostream& output) {
+	double run_seconds = m_runTime / 1e9, covered = 0;
+	map<string, string>::iterator routing = g_config_parameters.find("routing");
+
+	output << "PROFILE" << endl;
+	if (routing != g_config_parameters.end()) output << "Routing: " << routing->second << endl;
+	output << "Run Time (s): " << run_seconds << endl;
+	output << "Simulated Cycles: " << g_cycle << endl;
+	output << "Cycles/s: " << g_cycle / run_seconds << endl;
+	output << "Flits Delivered/s: " << g_rx_flit_counter / run_seconds << endl;
+	output << left << setw(28) << "phase" << right << setw(14) << "time (s)" << setw(10) << "percent" << setw(16)
+			<< "calls" << setw(14) << "ns/call" << endl;
+	for (int phase = 0; phase < PROF_NUM_PHASES; phase++) {
+		if (phase != PROF_ROUTING) covered += m_time[phase];
+		output << left << setw(28) << phaseName((ProfilePhase) phase) << right << setw(14) << m_time[phase] / 1e9
+				<< setw(10) << 100.0 * m_time[phase] / m_runTime << setw(16) << m_calls[phase] << setw(14)
+				<< (m_calls[phase] > 0 ? m_time[phase] / m_calls[phase] : 0) << endl;
+	}
+	output << left << setw(28) << "other" << right << setw(14) << (m_runTime - covered) / 1e9 << setw(10)
+			<< 100.0 * (m_runTime - covered) / m_runTime << endl;
+	output << left;
+}
@@ -0,0 +1,193 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "resultRecord.h"
+#include "histogram.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+
+resultRecord::resultRecord() {
+	m_record << setprecision(12) << "{";
+	m_firstField.push_back(true);
+}
+
+resultRecord::~resultRecord() {
+}
+
+void resultRecord::addKey(const string& key) {
+	if (!m_firstField.back()) m_record << ",";
+	m_firstField.back() = false;
+	m_record << "\"" << escape(key) << "\":";
+}
+
+/* JSON lacks NaN/Inf literals (e.g., from 0/0 averages): emit null instead */
+void resultRecord::addNumber(double value) {
+	if (std::isfinite(value))
+		m_record << value;
+	else
+		m_record << "null";
+}
+
+string resultRecord::escape(const string& text) {
+	string escaped;
+	for (unsigned int i = 0; i < text.size(); i++) {
+		switch (text[i]) {
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			case '\t':
+				escaped += "\\t";
+				break;
+			default:
+				/* Remaining control characters (e.g., '\r' from CRLF files) are not valid raw in JSON */
+				if ((unsigned char) text[i] < 0x20) {
+					char code[7];
+					snprintf(code, sizeof(code), "\\u%04x", (unsigned char) text[i]);
+					escaped += code;
+				} else
+					escaped += text[i];
+				break;
+		}
+	}
+	return escaped;
+}
+
+void resultRecord::add(const string& key, long long value) {
+	addKey(key);
+	m_record << value;
+}
+
+void resultRecord::add(const string& key, int value) {
+	addKey(key);
+	m_record << value;
+}
+
+void resultRecord::add(const string& key, double value) {
+	addKey(key);
+	addNumber(value);
+}
+
+void resultRecord::add(const string& key, long double value) {
+	addKey(key);
+	addNumber((double) value);
+}
+
+void resultRecord::add(const string& key, bool value) {
+	addKey(key);
+	m_record << (value ? "true" : "false");
+}
+
+void resultRecord::add(const string& key, const string& value) {
+	addKey(key);
+	m_record << "\"" << escape(value) << "\"";
+}
+
+void resultRecord::add(const string& key, const char * value) {
+	add(key, string(value));
+}
+
+void resultRecord::addArray(const string& key, const long long * values, int length) {
+	addKey(key);
+	m_record << "[";
+	for (int i = 0; i < length; i++) {
+		if (i > 0) m_record << ",";
+		m_record << values[i];
+	}
+	m_record << "]";
+}
+
+void resultRecord::addArray(const string& key, const double * values, int length) {
+	addKey(key);
+	m_record << "[";
+	for (int i = 0; i < length; i++) {
+		if (i > 0) m_record << ",";
+		addNumber(values[i]);
+	}
+	m_record << "]";
+}
+
+void resultRecord::addArray(const string& key, const vector<long long>& values) {
+	addArray(key, values.data(), values.size());
+}
+
+/*
+ * Histograms are stored sparsely, as a list of [bucket low value, count]
+ * pairs for non-empty buckets, along with summary percentiles.
+ */
+void resultRecord::addHistogram(const string& key, const logHistogram& hist) {
+	bool first = true;
+
+	beginObject(key);
+	add("count", hist.getTotalCount());
+	add("min", hist.getMinValue());
+	add("max", hist.getMaxValue());
+	add("p50", hist.getValueAtPercentile(50));
+	add("p99", hist.getValueAtPercentile(99));
+	add("p99.9", hist.getValueAtPercentile(99.9));
+	addKey("buckets");
+	m_record << "[";
+	for (int i = 0; i < hist.getNumBuckets(); i++) {
+		if (hist.getBucketCount(i) == 0) continue;
+		if (!first) m_record << ",";
+		first = false;
+		m_record << "[" << hist.getBucketLowValue(i) << "," << hist.getBucketCount(i) << "]";
+	}
+	m_record << "]";
+	endObject();
+}
+
+void resultRecord::beginObject(const string& key) {
+	addKey(key);
+	m_record << "{";
+	m_firstField.push_back(true);
+}
+
+void resultRecord::endObject() {
+	assert(m_firstField.size() > 1);
+	m_firstField.pop_back();
+	m_record << "}";
+}
+
+string resultRecord::toString() const {
+	assert(m_firstField.size() == 1);
+	return m_record.str() + "}";
+}
+
+void resultRecord::append(const char * file_name) const {
+	ofstream outputFile;
+
+	outputFile.open(file_name, ios::out | ios::app);
+	if (!outputFile) {
+		cerr << "Can't open the results record file " << file_name << endl;
+		exit(-1);
+	}
+	/* Whole line at once, so that records from concurrent runs (e.g., a sweep) are not interleaved */
+	string line = toString() + "\n";
+	outputFile.write(line.data(), line.size());
+	outputFile.close();
+}
@@ -0,0 +1,66 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef RESULTRECORD_H
+#define	RESULTRECORD_H
+
+#include "global.h"
+#include <sstream>
+#include <string>
+
+class logHistogram;
+
+/*
+ * Machine-oriented result sink: gathers all counters, per-port/per-VC
+ * arrays and histograms of a simulation run into a single JSON object,
+ * which is appended as one line to a JSON-lines results file. Several
+ * runs can share the same file, one record per run.
+ *
+ * Fields are emitted in insertion order; objects can be nested through
+ * beginObject()/endObject().
+ */
+class resultRecord {
+public:
+	resultRecord();
+	virtual ~resultRecord();
+	void add(const string& key, long long value);
+	void add(const string& key, int value);
+	void add(const string& key, double value);
+	void add(const string& key, long double value);
+	void add(const string& key, bool value);
+	void add(const string& key, const string& value);
+	void add(const string& key, const char * value);
+	void addArray(const string& key, const long long * values, int length);
+	void addArray(const string& key, const double * values, int length);
+	void addArray(const string& key, const vector<long long>& values);
+	void addHistogram(const string& key, const logHistogram& hist);
+	void beginObject(const string& key);
+	void endObject();
+	string toString() const;
+	void append(const char * file_name) const;
+private:
+	ostringstream m_record;
+	vector<bool> m_firstField; /* Whether next field is the first one of each open object */
+	void addKey(const string& key);
+	void addNumber(double value);
+	static string escape(const string& text);
+};
+
+#endif	/* RESULTRECORD_H */
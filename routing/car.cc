@@ -20,6 +20,7 @@
 
 //#include <iterator>
 #include "car.h"
+#include "../checkpoint.h"
 
 contAdpRouting::contAdpRouting(switchModule *switchM) :
 		baseRouting(switchM) {
@@ -400,3 +401,13 @@ bool contAdpRouting::misrouteCondition(flitModule * flit, int inPort) {
 	return result;
 }
 
+void contAdpRouting::checkpoint(checkpointFile &ckpt) {
+	baseRouting::checkpoint(ckpt);
+	for (int port = 0; port < portCount; port++)
+		for (int cos = 0; cos < g_cos_levels; cos++)
+			ckpt.array(lastValNodeSet[port][cos], g_channels);
+	if (g_congestion_detection == HISTORY_WINDOW || g_congestion_detection == HISTORY_WINDOW_AVG)
+		for (int port = 0; port < portCount; port++)
+			for (int cos = 0; cos < g_cos_levels; cos++)
+				ckpt.vect(congestionWindow[port][cos]);
+}
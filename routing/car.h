@@ -33,6 +33,7 @@ public:
 	contAdpRouting(switchModule *switchM);
 	~contAdpRouting();
 	candidate enroute(flitModule * flit, int inPort, int inVC);
+	void checkpoint(checkpointFile &ckpt);
 
 private:
 	MisrouteType misrouteType(int inport, int inchannel, flitModule * flit, int minOutPort, int minOutVC);
@@ -20,6 +20,8 @@
 
 #include "routing.h"
 #include "../flit/flitModule.h"
+#include "../checkpoint.h"
+#include "../memoryPlanner.h"
 
 baseRouting::baseRouting(switchModule *switchM) {
 	this->switchM = switchM;
@@ -29,7 +31,7 @@ baseRouting::baseRouting(switchModule *switchM) {
 
 	/* Create and fill in routing tables */
 	this->tableSwOut = new int[g_a_routers_per_group];
-	this->tableGroupOut = new int[g_a_routers_per_group * g_h_global_ports_per_router + 1];
+	this->tableGroupOut = new int[g_a_routers_per_group * g_h_global_ports_per_router];
 	setMinTables();
 	switch (g_deadlock_avoidance) {
 		case RING:
@@ -39,15 +41,24 @@ baseRouting::baseRouting(switchModule *switchM) {
 			this->tableOutRing2 = new int[g_number_switches];
 			this->tableInRing2 = new int[g_number_switches];
 			setRingTables();
+			tableOutRing1 = shareTable(tableOutRing1, g_number_switches);
+			tableInRing1 = shareTable(tableInRing1, g_number_switches);
+			tableOutRing2 = shareTable(tableOutRing2, g_number_switches);
+			tableInRing2 = shareTable(tableInRing2, g_number_switches);
 			break;
 		case EMBEDDED_TREE:
 			this->tableOutTree = new int[g_number_switches];
 			this->tableInTree = new int[g_number_switches];
 			setTreeTables();
+			tableOutTree = shareTable(tableOutTree, g_number_switches);
+			tableInTree = shareTable(tableInTree, g_number_switches);
 			break;
 		default:
 			break;
 	}
+	/* Min tables are shared once the escape tables, built upon them, are set */
+	tableSwOut = shareTable(tableSwOut, g_a_routers_per_group);
+	tableGroupOut = shareTable(tableGroupOut, g_a_routers_per_group * g_h_global_ports_per_router);
 
 	/* If misrouting trigger relays on congestion awareness, we need
 	 * to initialize globalLinkCongested array to check congestion status
@@ -74,9 +85,9 @@ baseRouting::baseRouting(switchModule *switchM) {
 
 baseRouting::~baseRouting() {
 	delete[] neighList;
-	delete[] neighPort;
-	delete[] tableSwOut;
-	delete[] tableGroupOut;
+	releaseTable(neighPort);
+	releaseTable(tableSwOut);
+	releaseTable(tableGroupOut);
 	switch (g_misrouting_trigger) {
 		case CGA:
 		case HYBRID:
@@ -91,14 +102,14 @@ baseRouting::~baseRouting() {
 	switch (g_deadlock_avoidance) {
 		case RING:
 		case EMBEDDED_RING:
-			delete[] tableInRing1;
-			delete[] tableOutRing1;
-			delete[] tableInRing2;
-			delete[] tableOutRing2;
+			releaseTable(tableInRing1);
+			releaseTable(tableOutRing1);
+			releaseTable(tableInRing2);
+			releaseTable(tableOutRing2);
 			break;
 		case EMBEDDED_TREE:
-			delete[] tableInTree;
-			delete[] tableOutTree;
+			releaseTable(tableInTree);
+			releaseTable(tableOutTree);
 			break;
 		default:
 			break;
@@ -106,48 +117,32 @@ baseRouting::~baseRouting() {
 }
 
 void baseRouting::setMinTables() {
-	int thisA, thisH, destP, destA, destH, destID, nextA, outPort, minPortCounter, offsetH, offsetHcmp, offsetA;
+	int thisA, destA, nextA, outPort, minPortCounter, offsetH, offsetA;
 	thisA = switchM->aPos;
-	thisH = switchM->hPos;
 	minPortCounter = (g_deadlock_avoidance == RING) ? portCount - 2 : portCount;
-	for (destH = 0; destH < ((g_h_global_ports_per_router * g_a_routers_per_group) + 1); destH++) {
-		if (g_palm_tree_configuration) {
-			offsetH = module((thisH - destH), (g_a_routers_per_group * g_h_global_ports_per_router + 1)) - 1;
-			offsetHcmp = module((destH - thisH), (g_a_routers_per_group * g_h_global_ports_per_router + 1)) - 1;
+	/* Group table is indexed by the offset of the dest group (see groupOffset()), so its
+	 * contents only depend on the position of the switch within its group */
+	for (offsetH = 0; offsetH < g_a_routers_per_group * g_h_global_ports_per_router; offsetH++) {
+		nextA = int(offsetH / g_h_global_ports_per_router);
+		offsetA = nextA - thisA;
+		if (offsetA != 0) {
+			if (offsetA > 0) offsetA--;
+			outPort = thisA + offsetA + g_local_router_links_offset;
 		} else {
-			if (destH > thisH) {
-				offsetH = destH - 1;
-				offsetHcmp = thisH;
-			} else {
-				offsetH = destH;
-				offsetHcmp = thisH - 1;
-			}
+			outPort = module(offsetH, g_h_global_ports_per_router) + g_global_router_links_offset;
 		}
-
-		if (destH != thisH) {
-			nextA = int(offsetH / g_h_global_ports_per_router);
-			offsetA = nextA - thisA;
-			if (offsetA != 0) {
-				if (offsetA > 0) offsetA--;
-				outPort = thisA + offsetA + g_local_router_links_offset;
-			} else {
-				outPort = module(offsetH, g_h_global_ports_per_router) + g_global_router_links_offset;
-			}
+		assert(outPort < minPortCounter); /* Sanity check: out port can't be higher than router ports range */
+		tableGroupOut[offsetH] = outPort;
+	}
+	for (destA = 0; destA < g_a_routers_per_group; destA++) {
+		if (destA != thisA) {
+			offsetA = destA - thisA;
+			if (offsetA > 0) offsetA--;
+			outPort = thisA + offsetA + g_local_router_links_offset;
 			assert(outPort < minPortCounter); /* Sanity check: out port can't be higher than router ports range */
-			tableGroupOut[destH] = outPort;
-			continue;
+			tableSwOut[destA] = outPort;
 		} else
-			tableGroupOut[destH] = -1;
-		for (destA = 0; destA < g_a_routers_per_group; destA++) {
-			if (destA != thisA) {
-				offsetA = destA - thisA;
-				if (offsetA > 0) offsetA--;
-				outPort = thisA + offsetA + g_local_router_links_offset;
-				assert(outPort < minPortCounter); /* Sanity check: out port can't be higher than router ports range */
-				tableSwOut[destA] = outPort;
-			} else
-				tableSwOut[destA] = -1;
-		}
+			tableSwOut[destA] = -1;
 	}
 }
 
@@ -170,7 +165,7 @@ int baseRouting::minOutputPort(int dest) {
 							+ destH * g_a_routers_per_group * g_p_computing_nodes_per_router);
 
 	if (destH != switchM->hPos)
-		port = tableGroupOut[destH];
+		port = tableGroupOut[groupOffset(switchM->hPos, destH)];
 	else if (destA != switchM->aPos)
 		port = tableSwOut[destA];
 	else
@@ -203,19 +198,13 @@ int baseRouting::minInputPort(int dest) {
 	thisH = switchM->hPos;
 
 	/* Routing tables will depend on network distribution, which can be 'Palm Tree' or not.
-	 * This will mainly affect port offset amongst groups */
-	if (g_palm_tree_configuration) {
-		offsetH = module((thisH - destH), (g_a_routers_per_group * g_h_global_ports_per_router + 1)) - 1;
-		offsetHcmp = module((destH - thisH), (g_a_routers_per_group * g_h_global_ports_per_router + 1)) - 1;
-	} else {
-		offsetH = (destH > thisH) ? destH - 1 : destH;
-		offsetHcmp = (destH > thisH) ? thisH : thisH - 1;
-	}
-	/* After this point, output port is calculated equally for any network distribution.
+	 * This will mainly affect port offset amongst groups, which is abstracted by groupOffset().
 	 * If source and dest group, next hop will be for a local router linked to dest group */
-	if (thisH != destH)
+	if (thisH != destH) {
+		offsetH = groupOffset(thisH, destH);
+		offsetHcmp = groupOffset(destH, thisH);
 		nextA = int(offsetH / g_h_global_ports_per_router);
-	else
+	} else
 		nextA = destA;
 
 	/* If next local router is different from current, ports will be calculated upon the
@@ -423,6 +412,7 @@ void baseRouting::visitNeighbors() {
 			 * or to previous (one port more) */
 			neighPort[port] = (port == portCount - 1) ? port - 1 : port + 1;
 	}
+	neighPort = shareTable(neighPort, portCount);
 }
 
 /*
@@ -967,3 +957,18 @@ void baseRouting::setValNode(flitModule * flit) {
 	assert(0 < valDest < g_number_generators);
 	flit->valId = valDest;
 }
+
+/* Routing state that outlasts a cycle: congestion status of global links, when in use */
+void baseRouting::checkpoint(checkpointFile &ckpt) {
+	switch (g_misrouting_trigger) {
+		case CGA:
+		case HYBRID:
+		case HYBRID_REMOTE:
+			for (int j = 0; j < g_channels; j++)
+				for (int c = 0; c < g_cos_levels; c++)
+					ckpt.array(globalLinkCongested[j][c], g_h_global_ports_per_router);
+			break;
+		default:
+			break;
+	}
+}
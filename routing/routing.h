@@ -31,6 +31,7 @@
 
 class switchModule;
 class flitModule;
+class checkpointFile;
 
 struct candidate {
 	int port;
@@ -66,6 +67,7 @@ public:
 	int hopsToDest(flitModule * flit, int outP);
 	int hopsToDest(int destination);
 	void setValNode(flitModule * flit);
+	virtual void checkpoint(checkpointFile &ckpt);
 
 private:
 	void setMinTables();
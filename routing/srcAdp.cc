@@ -19,6 +19,7 @@
  */
 
 #include "srcAdp.h"
+#include "../checkpoint.h"
 
 sourceAdp::sourceAdp(switchModule *switchM) :
 		baseRouting(switchM) {
@@ -253,3 +254,10 @@ bool sourceAdp::misrouteCondition(flitModule * flit, int inPort) {
 
 	return result;
 }
+
+void sourceAdp::checkpoint(checkpointFile &ckpt) {
+	baseRouting::checkpoint(ckpt);
+	for (int port = 0; port < portCount; port++)
+		for (int cos = 0; cos < g_cos_levels; cos++)
+			ckpt.array(lastValNodeSet[port][cos], g_channels);
+}
@@ -31,6 +31,7 @@ public:
 	sourceAdp(switchModule *switchM);
 	~sourceAdp();
 	candidate enroute(flitModule * flit, int inPort, int inVC);
+	void checkpoint(checkpointFile &ckpt);
 
 private:
 	MisrouteType misrouteType(int inport, int inchannel, flitModule * flit, int minOutPort, int minOutVC);
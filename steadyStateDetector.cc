@@ -0,0 +1,114 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "steadyStateDetector.h"
+#include "switch/switchModule.h"
+
+const char * steadyStateDetector::METRIC_NAMES[NUM_METRICS] = { "Accepted Load", "Latency", "Buffer Occupancy" };
+
+steadyStateDetector::steadyStateDetector(long long window) :
+		m_window(window), m_warmupLimit(g_warmup_cycles), m_converged(false), m_lastRxFlits(g_rx_flit_counter),
+		m_lastFlitLatency(g_flit_latency) {
+	assert(m_window > 0);
+	for (int metric = 0; metric < NUM_METRICS; metric++) {
+		m_series[metric].reserve(m_warmupLimit / m_window + 1);
+		m_truncation[metric] = -1;
+	}
+}
+
+/*
+ * Records the observations of the window that ends in current cycle,
+ * and tests the series for stationarity on every complete batch.
+ * Returns true once all of them are stationary.
+ */
+bool steadyStateDetector::sample() {
+	long long rx_flits = g_rx_flit_counter - m_lastRxFlits;
+	double occupancy = 0;
+	int i, metric;
+
+	m_series[0].push_back(1.0 * rx_flits * g_flit_size / (1.0 * g_number_generators * m_window));
+	/* Windows without receptions keep the latest latency */
+	if (rx_flits > 0)
+		m_series[1].push_back((g_flit_latency - m_lastFlitLatency) / rx_flits);
+	else
+		m_series[1].push_back(m_series[1].empty() ? 0 : m_series[1].back());
+	for (i = 0; i < g_number_switches; i++)
+		occupancy += g_switches_list[i]->getTotalOccupancy();
+	m_series[2].push_back(occupancy);
+	m_lastRxFlits = g_rx_flit_counter;
+	m_lastFlitLatency = g_flit_latency;
+
+	if (m_series[0].size() % BATCH_SIZE != 0 || getBatches() < MIN_BATCHES) return false;
+	m_converged = true;
+	for (metric = 0; metric < NUM_METRICS; metric++) {
+		m_truncation[metric] = mserTruncation(m_series[metric]);
+		if (m_truncation[metric] < 0) m_converged = false;
+	}
+	return m_converged;
+}
+
+/*
+ * MSER-5 truncation point of a series, in batches: the number of initial
+ * batches whose removal minimizes the variance of the mean of the rest,
+ * MSER(d) = sum_{j>d} (b_j - mean_d)^2 / (k - d)^2. Returns -1 if it lies
+ * in the second half of the series, as the transient has not ended yet.
+ */
+int steadyStateDetector::mserTruncation(const vector<double> &series) {
+	int batches = series.size() / BATCH_SIZE, d, j, best = 0;
+	double sum = 0, sum_squares = 0, mser, best_mser = 0;
+	vector<double> batch_means(batches);
+
+	for (j = 0; j < batches; j++) {
+		batch_means[j] = 0;
+		for (int i = 0; i < BATCH_SIZE; i++)
+			batch_means[j] += series[j * BATCH_SIZE + i];
+		batch_means[j] /= BATCH_SIZE;
+	}
+	/* Suffix sums, from the last batch backwards */
+	for (d = batches - 1; d >= 0; d--) {
+		sum += batch_means[d];
+		sum_squares += batch_means[d] * batch_means[d];
+		if (d == batches - 1) continue;
+		int remaining = batches - d;
+		mser = (sum_squares - sum * sum / remaining) / (1.0 * remaining * remaining);
+		if (d == batches - 2 || mser <= best_mser) {
+			best_mser = mser;
+			best = d;
+		}
+	}
+	return (best <= batches / 2) ? best : -1;
+}
+
+void steadyStateDetector::writeOutput(ostream &output) const {
+	output << "Steady State Detection: MSER-" << BATCH_SIZE << " over " << m_window << "-cycle windows" << endl;
+	if (m_converged)
+		output << "Steady State: converged at cycle " << g_warmup_cycles << " (warmup limit: " << m_warmupLimit << ")"
+				<< endl;
+	else
+		output << "Steady State: not converged (warmup limit: " << m_warmupLimit << ")" << endl;
+	for (int metric = 0; metric < NUM_METRICS; metric++) {
+		output << "MSER Truncation " << METRIC_NAMES[metric] << ": ";
+		if (m_truncation[metric] < 0)
+			output << "not stationary";
+		else
+			output << m_truncation[metric] << " of " << getBatches() << " batches";
+		output << endl;
+	}
+}
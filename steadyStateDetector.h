@@ -0,0 +1,72 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef STEADYSTATEDETECTOR_H
+#define	STEADYSTATEDETECTOR_H
+
+#include "global.h"
+
+/*
+ * Online steady-state detector, to end warmup as soon as the network
+ * has converged. Every 'window' cycles it records the accepted load,
+ * the average latency of the flits received, and the phits stored in
+ * switch buffers. Each series is tested with MSER-5: observations are
+ * grouped into batches of 5, and the truncation point minimizing the
+ * MSER statistic is sought; a series is deemed stationary once that
+ * point lies within the first half of its batches. Warmup ends when
+ * all series are stationary, or at the configured warmup length.
+ */
+class steadyStateDetector {
+public:
+	steadyStateDetector(long long window);
+	/* Cheap check to be done every warmup cycle */
+	inline bool isSampleDue() const {
+		return (g_cycle + 1) % m_window == 0;
+	}
+	bool sample();
+	void writeOutput(ostream &output) const;
+	long long getWarmupLimit() const {
+		return m_warmupLimit;
+	}
+	bool isConverged() const {
+		return m_converged;
+	}
+	int getTruncation(int metric) const {
+		return m_truncation[metric];
+	}
+	int getBatches() const {
+		return m_series[0].size() / BATCH_SIZE;
+	}
+	static const int NUM_METRICS = 3;
+	static const int BATCH_SIZE = 5;
+	static const int MIN_BATCHES = 10;
+	static const char * METRIC_NAMES[NUM_METRICS];
+private:
+	long long m_window;
+	long long m_warmupLimit; /* Configured warmup length, employed as upper bound */
+	bool m_converged;
+	vector<double> m_series[NUM_METRICS];
+	int m_truncation[NUM_METRICS]; /* MSER-5 truncation point of every series, in batches (-1 if not stationary) */
+	long long m_lastRxFlits;
+	long double m_lastFlitLatency;
+	static int mserTruncation(const vector<double> &series);
+};
+
+#endif	/* STEADYSTATEDETECTOR_H */
@@ -0,0 +1,783 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "sweep.h"
+#include "global.h"
+#include "dgflySimulator.h"
+#include "generator/generatorModule.h"
+#include "batchMeans.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <math.h>
+
+/* Within a run of a saturation search, pipe where its accepted load is reported */
+static int g_sweep_report_fd = -1;
+
+/* Every run is named after the output file name and the parameter values it sets */
+static string runOutputName(const string &label) {
+	return string(g_output_file_name) + "_" + label;
+}
+
+static string sweepOutputName(const string &value) {
+	return runOutputName(g_sweep_key + value);
+}
+
+/* Console output of every run goes to its own file, not to be interleaved */
+static void redirectSweepOutput(const string &name) {
+	string log_name = name + ".log";
+	int fd = open(log_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		cerr << "Can't open the sweep log file: " << log_name << endl;
+		_exit(-1);
+	}
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+}
+
+/*
+ * Whether runs can share the network built by the sweep process. Only
+ * the injection probability (or the seed, for replications) can be
+ * updated once generators are built, and only for those traffic types
+ * that do not derive other parameters from it while reading the
+ * configuration.
+ */
+bool sweepSharesNetwork() {
+	if (strcmp(g_sweep_key, "Probability") != 0 && g_replications == 0) return false;
+	return g_traffic != TRACE && g_traffic != GRAPH500 && g_traffic != ALL2ALL && g_traffic != SINGLE_BURST
+			&& g_traffic != TRANSIENT;
+}
+
+/* Within a child process, results and console output are redirected to the files of its run */
+static void setRunOutput(const string &name) {
+	redirectSweepOutput(name);
+	delete[] g_output_file_name;
+	g_output_file_name = new char[name.length() + 1];
+	strcpy(g_output_file_name, name.c_str());
+	g_config_parameters["OutputFileName"] = name;
+}
+
+/* Updates the injection probability of the generators already built, same as in readConfiguration() */
+static void setSharedProbability(const string &value) {
+	g_injection_probability = atof(value.c_str());
+	if (g_reactive_traffic) g_injection_probability /= 2;
+	for (int i = 0; i < g_number_generators; i++)
+		g_generators_list[i]->setInjectionProbability(g_injection_probability);
+}
+
+/* Restarts the random number generators with another seed, same as in main() */
+static void setSharedSeed(const string &value) {
+	g_seed = atoll(value.c_str());
+	initstate(g_seed, (char *) g_rand_state, sizeof(g_rand_state));
+	g_reng.seed(g_seed);
+	for (int i = 0; i < g_number_generators; i++)
+		g_generators_list[i]->seedTraffic();
+}
+
+/* Sets up a child process to simulate one value, over the network already built */
+static void setupSharedRun(const string &value) {
+	setRunOutput(sweepOutputName(value));
+	g_config_parameters[g_sweep_key] = value;
+	if (g_replications > 0)
+		setSharedSeed(value);
+	else
+		setSharedProbability(value);
+}
+
+/* Replaces a child process by a new simulator instance, with the parameters of its run overridden */
+static void execRun(int argc, char *argv[], const string &name, const vector<pair<string, string> > &overrides) {
+	vector<string> args(argv, argv + argc);
+	vector<char *> exec_args;
+	unsigned int i;
+
+	for (i = 0; i < overrides.size(); i++)
+		args.push_back(overrides[i].first + "=" + overrides[i].second);
+	args.push_back("OutputFileName=" + name);
+	args.push_back("SweepKey=");
+	args.push_back("BatchAxes=");
+	/* Records of all runs are kept together */
+	if (g_results_format != TEXT) args.push_back(string("ResultsFile=") + g_results_file_name);
+	for (i = 0; i < args.size(); i++)
+		exec_args.push_back(&args[i][0]);
+	exec_args.push_back(NULL);
+
+	redirectSweepOutput(name);
+	execvp(argv[0], &exec_args[0]);
+	cerr << "Can't run the simulator for " << name << endl;
+	_exit(-1);
+}
+
+static unsigned int sweepJobs() {
+	return (g_sweep_jobs > 0) ? g_sweep_jobs : sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/*
+ * Forks the child process of a run, and returns its pid (0 within the
+ * child). If given, 'report' receives the end of a pipe where the run
+ * writes its results.
+ */
+static pid_t forkRun(int *report) {
+	int fds[2];
+	pid_t pid;
+
+	if (report != NULL && pipe(fds) != 0) {
+		cerr << "ERROR: can't create a pipe for the sweep" << endl;
+		exit(-1);
+	}
+	cout.flush();
+	fflush(stdout);
+	pid = fork();
+	if (pid < 0) {
+		cerr << "ERROR: can't create a process for the sweep" << endl;
+		exit(-1);
+	}
+	if (pid == 0) {
+		if (report != NULL) {
+			close(fds[0]);
+			g_sweep_report_fd = fds[1];
+		}
+		return 0;
+	}
+	if (report != NULL) {
+		close(fds[1]);
+		*report = fds[0];
+	}
+	return pid;
+}
+
+/*
+ * Starts the run for one value in a child process, and returns its pid;
+ * within the child, it only returns (0) when the simulation has to be
+ * carried out over the shared network.
+ */
+static pid_t startRun(int argc, char *argv[], const string &value, bool shared, int *report) {
+	pid_t pid = forkRun(report);
+
+	if (pid == 0) {
+		if (shared) {
+			setupSharedRun(value);
+			return 0;
+		}
+		execRun(argc, argv, sweepOutputName(value), vector<pair<string, string> >(1, make_pair(g_sweep_key, value)));
+	}
+	return pid;
+}
+
+/* Waits for any of the running children to end, and returns the run it was simulating */
+static unsigned int waitRun(map<pid_t, unsigned int> &running, bool &success) {
+	unsigned int run;
+	int status;
+	pid_t pid;
+
+	pid = wait(&status);
+	if (pid < 0) {
+		cerr << "ERROR: lost track of the sweep processes" << endl;
+		exit(-1);
+	}
+	run = running[pid];
+	running.erase(pid);
+	success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	return run;
+}
+
+/* One point of the load curve sampled by the saturation search */
+struct saturationProbe {
+	double probability;
+	double accepted_load;
+	bool saturated;
+
+	bool operator<(const saturationProbe &other) const {
+		return probability < other.probability;
+	}
+};
+
+/* Writes the outcome of the search, and the load curve it has sampled */
+static void writeSaturationReport(ostream &output, vector<saturationProbe> curve, double lo, double hi) {
+	double peak = 0, throughput = 0;
+	unsigned int i;
+
+	sort(curve.begin(), curve.end());
+	for (i = 0; i < curve.size(); i++) {
+		peak = max(peak, curve[i].accepted_load);
+		if (curve[i].probability == lo) throughput = curve[i].accepted_load;
+	}
+	if (lo == hi)
+		output << "Saturation point: not reached (Probability=" << hi << " is not saturated)" << endl;
+	else
+		output << "Saturation point: Probability between " << lo << " and " << hi << endl;
+	output << "Saturation Throughput: " << throughput << " phits/(node·cycle)" << endl;
+	output << "Peak Accepted Load: " << peak << " phits/(node·cycle)" << endl;
+	output << "Probability\tOffered Load\tAccepted Load\tSaturated" << endl;
+	for (i = 0; i < curve.size(); i++)
+		output << curve[i].probability << "\t" << curve[i].probability / 100 << "\t" << curve[i].accepted_load << "\t"
+				<< curve[i].saturated << endl;
+}
+
+/*
+ * Saturation search. The saturation point lies in (lo, hi]: initially,
+ * hi is the maximum probability, and it is probed along with the first
+ * round to check the network does saturate. Every round, the lowest
+ * saturated probe becomes hi and the highest non-saturated probe below
+ * it becomes lo. Loads are in phits/(node·cycle), so that a probability
+ * of 100 offers 1 phit per cycle.
+ */
+static void runSaturationSearch(int argc, char *argv[]) {
+	unsigned int jobs = sweepJobs(), k;
+	double lo = 0, hi = 100, new_lo, new_hi;
+	bool hi_checked = false, success;
+	vector<saturationProbe> curve, round;
+	map<pid_t, unsigned int> running;
+	vector<int> reports;
+	saturationProbe probe;
+	string report;
+	char buffer[64];
+	ssize_t length;
+	pid_t pid;
+
+	if (!sweepSharesNetwork()) {
+		cerr << "ERROR: saturation search is not supported with this traffic type" << endl;
+		exit(-1);
+	}
+	cout << "Saturation search: up to " << jobs << " runs at a time, until bracketed within "
+			<< g_saturation_tolerance << " probability points" << endl;
+	while (hi - lo > g_saturation_tolerance) {
+		round.clear();
+		reports.assign(jobs, -1);
+		for (k = 0; k < jobs; k++) {
+			ostringstream value;
+			value << (hi_checked ? lo + (hi - lo) * (k + 1) / (jobs + 1) : lo + (hi - lo) * (k + 1) / jobs);
+			g_sweep_values.push_back(value.str());
+			pid = startRun(argc, argv, value.str(), true, &reports[k]);
+			if (pid == 0) return;
+			running[pid] = g_sweep_values.size() - 1;
+		}
+		for (k = 0; k < jobs; k++) {
+			const string &value = g_sweep_values[g_sweep_values.size() - jobs + k];
+			report.clear();
+			while ((length = read(reports[k], buffer, sizeof(buffer))) > 0)
+				report.append(buffer, length);
+			close(reports[k]);
+			probe.probability = atof(value.c_str());
+			if (report.empty()) {
+				cerr << "ERROR: run with Probability=" << value << " failed, see " << sweepOutputName(value) << ".log"
+						<< endl;
+				exit(-1);
+			}
+			probe.accepted_load = atof(report.c_str());
+			probe.saturated = probe.accepted_load < g_saturation_ratio * probe.probability / 100;
+			round.push_back(probe);
+			cout << "Probability=" << value << "\tAccepted Load: " << probe.accepted_load
+					<< (probe.saturated ? " (saturated)" : "") << endl;
+		}
+		/* Runs have already reported their results */
+		while (!running.empty())
+			waitRun(running, success);
+		curve.insert(curve.end(), round.begin(), round.end());
+
+		new_hi = hi;
+		for (k = 0; k < round.size(); k++)
+			if (round[k].saturated) new_hi = min(new_hi, round[k].probability);
+		if (!hi_checked && new_hi == hi && !round.back().saturated) {
+			lo = hi; /* Network does not saturate */
+			break;
+		}
+		hi_checked = true;
+		new_lo = lo;
+		for (k = 0; k < round.size(); k++)
+			if (!round[k].saturated && round[k].probability < new_hi) new_lo = max(new_lo, round[k].probability);
+		lo = new_lo;
+		hi = new_hi;
+	}
+
+	string report_name = string(g_output_file_name) + ".saturation";
+	ofstream report_file(report_name.c_str(), ios::out | ios::trunc);
+	if (!report_file) {
+		cerr << "Can't open the saturation search file: " << report_name << endl;
+		exit(-1);
+	}
+	writeSaturationReport(report_file, curve, lo, hi);
+	writeSaturationReport(cout, curve, lo, hi);
+	exit(0);
+}
+
+/* Results reported by every replication */
+static const int REPLICATION_METRICS = 3;
+static const char * REPLICATION_METRIC_NAMES[REPLICATION_METRICS] = { "Accepted Load", "Flit Latency",
+		"Packet Latency" };
+
+/* Writes the results of every replication, and their means with 95% confidence intervals */
+static void writeReplicationReport(ostream &output, const vector<vector<double> > &results) {
+	unsigned int i, n = results.size();
+	double mean, variance;
+	int metric;
+
+	output << "Replications: " << n << " (Seed " << g_sweep_values[0] << " to " << g_sweep_values[n - 1] << ")"
+			<< (g_common_random_numbers ? ", common random numbers" : "") << endl;
+	for (metric = 0; metric < REPLICATION_METRICS; metric++) {
+		mean = variance = 0;
+		for (i = 0; i < n; i++)
+			mean += results[i][metric];
+		mean /= n;
+		for (i = 0; i < n; i++)
+			variance += (results[i][metric] - mean) * (results[i][metric] - mean);
+		variance /= n - 1;
+		output << "Mean " << REPLICATION_METRIC_NAMES[metric] << ": " << mean << " +- "
+				<< batchMeans::tQuantile(n - 1) * sqrt(variance / n) << " (95% CI)" << endl;
+	}
+	output << "Seed";
+	for (metric = 0; metric < REPLICATION_METRICS; metric++)
+		output << "\t" << REPLICATION_METRIC_NAMES[metric];
+	output << endl;
+	for (i = 0; i < n; i++) {
+		output << g_sweep_values[i];
+		for (metric = 0; metric < REPLICATION_METRICS; metric++)
+			output << "\t" << results[i][metric];
+		output << endl;
+	}
+}
+
+/*
+ * Replications: every seed is simulated over the network already built,
+ * keeping up to SweepJobs of them running, and each one reports its
+ * results back through a pipe, to be aggregated once all have ended.
+ */
+static void runReplications() {
+	unsigned int jobs = sweepJobs(), next = 0, run;
+	vector<vector<double> > results(g_sweep_values.size());
+	vector<int> reports(g_sweep_values.size(), -1);
+	map<pid_t, unsigned int> running;
+	bool success;
+	string report;
+	char buffer[128];
+	ssize_t length;
+	pid_t pid;
+
+	if (!sweepSharesNetwork()) {
+		cerr << "ERROR: replications are not supported with this traffic type" << endl;
+		exit(-1);
+	}
+	cout << "Replications: " << g_sweep_values.size() << " seeds, up to " << jobs << " at a time" << endl;
+	while (next < g_sweep_values.size() || !running.empty()) {
+		if (next < g_sweep_values.size() && running.size() < jobs) {
+			pid = startRun(0, NULL, g_sweep_values[next], true, &reports[next]);
+			if (pid == 0) return;
+			running[pid] = next++;
+			continue;
+		}
+
+		run = waitRun(running, success);
+		report.clear();
+		while ((length = read(reports[run], buffer, sizeof(buffer))) > 0)
+			report.append(buffer, length);
+		close(reports[run]);
+		istringstream values(report);
+		results[run].resize(REPLICATION_METRICS);
+		for (int metric = 0; metric < REPLICATION_METRICS; metric++)
+			values >> results[run][metric];
+		if (!success || !values) {
+			cerr << "ERROR: run with Seed=" << g_sweep_values[run] << " failed, see "
+					<< sweepOutputName(g_sweep_values[run]) << ".log" << endl;
+			exit(-1);
+		}
+		cout << "Seed=" << g_sweep_values[run] << " finished, results in " << sweepOutputName(g_sweep_values[run])
+				<< endl;
+	}
+
+	string report_name = string(g_output_file_name) + ".replications";
+	ofstream report_file(report_name.c_str(), ios::out | ios::trunc);
+	if (!report_file) {
+		cerr << "Can't open the replications file: " << report_name << endl;
+		exit(-1);
+	}
+	writeReplicationReport(report_file, results);
+	writeReplicationReport(cout, results);
+	exit(0);
+}
+
+/*
+ * Simulates every value of the sweep in a child process, keeping up to
+ * SweepJobs of them running. The sweep process exits once all of them
+ * have ended, so this function only returns within a child process that
+ * has to carry out its simulation over the shared network.
+ */
+void runSweep(int argc, char *argv[]) {
+	bool shared = sweepSharesNetwork(), success;
+	unsigned int jobs = sweepJobs(), next = 0, failed = 0, run;
+	map<pid_t, unsigned int> running;
+	pid_t pid;
+
+	if (g_saturation_search) {
+		runSaturationSearch(argc, argv);
+		return;
+	}
+	if (g_replications > 0) {
+		runReplications();
+		return;
+	}
+	cout << "Sweep over " << g_sweep_key << ": " << g_sweep_values.size() << " runs, up to " << jobs
+			<< " at a time" << (shared ? " over a shared network" : "") << endl;
+	while (next < g_sweep_values.size() || !running.empty()) {
+		if (next < g_sweep_values.size() && running.size() < jobs) {
+			pid = startRun(argc, argv, g_sweep_values[next], shared, NULL);
+			if (pid == 0) return;
+			running[pid] = next++;
+			continue;
+		}
+
+		run = waitRun(running, success);
+		const string &value = g_sweep_values[run];
+		if (success) {
+			cout << g_sweep_key << "=" << value << " finished, results in " << sweepOutputName(value) << endl;
+		} else {
+			cerr << "ERROR: run with " << g_sweep_key << "=" << value << " failed, see " << sweepOutputName(value)
+					<< ".log" << endl;
+			failed++;
+		}
+	}
+	cout << "Sweep finished: " << g_sweep_values.size() - failed << " of " << g_sweep_values.size()
+			<< " runs completed" << endl;
+	exit(failed > 0 ? -1 : 0);
+}
+
+/* Splits a variant into its 'key=value' overrides */
+static vector<pair<string, string> > branchOverrides(const string &variant) {
+	vector<pair<string, string> > overrides;
+	istringstream items(variant);
+	string item;
+	size_t separator;
+
+	while (getline(items, item, ';')) {
+		separator = item.find('=');
+		if (separator == string::npos || separator == 0) {
+			cerr << "ERROR: branch variant '" << variant << "' must be given as key=value[;key=value...]" << endl;
+			exit(-1);
+		}
+		overrides.push_back(make_pair(item.substr(0, separator), item.substr(separator + 1)));
+	}
+	return overrides;
+}
+
+/*
+ * Whether a parameter can be changed once the network has been built
+ * and warmed up: only those read by the simulator as it runs qualify.
+ */
+static bool isBranchParameter(const string &key) {
+	if (key == "Probability")
+		return g_traffic != TRANSIENT && g_traffic != ALL2ALL && g_traffic != SINGLE_BURST;
+	if (key == "transientTrafficCycle" || key == "transientTrafficSecondPattern" || key == "transientTrafficNextDist"
+			|| key == "transientTrafficSecondProbability") return g_traffic == TRANSIENT;
+	if (key == "QCNThreshold1" || key == "QCNThreshold2" || key == "QCN_GD" || key == "QCN_R_AI"
+			|| key == "QCN_MIN_RATE") return g_congestion_management == QCNSW;
+	if (key == "acorHystCycles" || key == "acorInc1Packets" || key == "acorDec1Packets" || key == "acorInc2Packets"
+			|| key == "acorDec2Packets") return g_routing == ACOR || g_routing == PB_ACOR;
+	return false;
+}
+
+/* Same as in readConfiguration() */
+static void setBranchParameter(const string &key, const string &value) {
+	if (key == "Probability")
+		setSharedProbability(value);
+	else if (key == "transientTrafficCycle")
+		g_transient_traffic_cycle = atoi(value.c_str());
+	else if (key == "transientTrafficSecondPattern")
+		readTrafficPattern(value.c_str(), &g_phase_traffic_type[1]);
+	else if (key == "transientTrafficNextDist")
+		g_phase_traffic_adv_dist[1] = atoi(value.c_str());
+	else if (key == "transientTrafficSecondProbability")
+		g_phase_traffic_probability[1] = atof(value.c_str());
+	else if (key == "QCNThreshold1")
+		g_qcn_th1 = atoi(value.c_str());
+	else if (key == "QCNThreshold2")
+		g_qcn_th2 = atoi(value.c_str());
+	else if (key == "QCN_GD")
+		g_qcn_gd = atof(value.c_str());
+	else if (key == "QCN_R_AI")
+		g_qcn_r_ai = atof(value.c_str());
+	else if (key == "QCN_MIN_RATE")
+		g_qcn_min_rate = atof(value.c_str());
+	else if (key == "acorHystCycles")
+		g_acor_hysteresis_cycle_duration_cycles = atoi(value.c_str());
+	else if (key == "acorInc1Packets")
+		g_acor_inc_state_first_th_packets = atoi(value.c_str());
+	else if (key == "acorDec1Packets")
+		g_acor_dec_state_first_th_packets = atoi(value.c_str());
+	else if (key == "acorInc2Packets")
+		g_acor_inc_state_second_th_packets = atoi(value.c_str());
+	else if (key == "acorDec2Packets")
+		g_acor_dec_state_second_th_packets = atoi(value.c_str());
+}
+
+/* Every variant is named after the values it sets */
+static string branchOutputName(const string &variant) {
+	vector<pair<string, string> > overrides = branchOverrides(variant);
+	string label;
+
+	for (unsigned int i = 0; i < overrides.size(); i++)
+		label += (i > 0 ? "_" : "") + overrides[i].first + overrides[i].second;
+	return runOutputName(label);
+}
+
+/*
+ * Checks, before any cycle is simulated, that all variants can be
+ * branched from the state reached by a single process.
+ */
+void checkBranchVariants() {
+	vector<pair<string, string> > overrides;
+	unsigned int i, j;
+
+	if (g_sweep_key != NULL || !g_batch_axes.empty()) {
+		cerr << "ERROR: BranchVariants can not be employed within a sweep or a batch" << endl;
+		exit(-1);
+	}
+	if (g_traffic == TRACE || g_traffic == GRAPH500) {
+		cerr << "ERROR: BranchVariants is not supported with this traffic type" << endl;
+		exit(-1);
+	}
+	/* Sampler thread does not survive the fork, and periodic checkpoints would share the same file */
+	if (g_sample_cycles > 0 || g_checkpoint_interval > 0) {
+		cerr << "ERROR: BranchVariants can not be employed along with SampleCycles or CheckpointInterval" << endl;
+		exit(-1);
+	}
+	for (i = 0; i < g_branch_variants.size(); i++) {
+		overrides = branchOverrides(g_branch_variants[i]);
+		for (j = 0; j < overrides.size(); j++) {
+			if (!isBranchParameter(overrides[j].first)) {
+				cerr << "ERROR: parameter " << overrides[j].first << " can not be changed in a branch variant" << endl;
+				exit(-1);
+			}
+		}
+	}
+}
+
+/*
+ * Branches every variant from current state in a child process, keeping
+ * up to SweepJobs of them running; the state reached so far is shared
+ * among them (copy-on-write). The parent process exits once all of them
+ * have ended, so this function only returns within a child process,
+ * with the parameters of its variant already in place.
+ */
+void runBranches() {
+	unsigned int jobs = sweepJobs(), next = 0, failed = 0, run, i;
+	map<pid_t, unsigned int> running;
+	vector<pair<string, string> > overrides;
+	bool success;
+	pid_t pid;
+
+	cout << "Branching " << g_branch_variants.size() << " variants at cycle " << g_cycle << ", up to " << jobs
+			<< " at a time" << endl;
+	while (next < g_branch_variants.size() || !running.empty()) {
+		if (next < g_branch_variants.size() && running.size() < jobs) {
+			pid = forkRun(NULL);
+			if (pid == 0) {
+				setRunOutput(branchOutputName(g_branch_variants[next]));
+				openOutputFile();
+				overrides = branchOverrides(g_branch_variants[next]);
+				for (i = 0; i < overrides.size(); i++) {
+					g_config_parameters[overrides[i].first] = overrides[i].second;
+					setBranchParameter(overrides[i].first, overrides[i].second);
+				}
+				return;
+			}
+			running[pid] = next++;
+			continue;
+		}
+
+		run = waitRun(running, success);
+		const string &variant = g_branch_variants[run];
+		if (success) {
+			cout << "Variant " << variant << " finished, results in " << branchOutputName(variant) << endl;
+		} else {
+			cerr << "ERROR: variant " << variant << " failed, see " << branchOutputName(variant) << ".log" << endl;
+			failed++;
+		}
+	}
+	cout << "Branching finished: " << g_branch_variants.size() - failed << " of " << g_branch_variants.size()
+			<< " variants completed" << endl;
+	exit(failed > 0 ? -1 : 0);
+}
+
+/* One run of a batch: a value for every axis */
+struct batchRun {
+	vector<pair<string, string> > overrides;
+	string name;
+};
+
+/* Every combination of the values of the axes, the last axis varying fastest */
+static vector<batchRun> batchRuns() {
+	vector<unsigned int> index(g_batch_axes.size(), 0);
+	vector<batchRun> runs;
+	unsigned int axis;
+
+	do {
+		batchRun run;
+		string label;
+		for (axis = 0; axis < g_batch_axes.size(); axis++) {
+			run.overrides.push_back(make_pair(g_batch_axes[axis], g_batch_values[axis][index[axis]]));
+			label += (axis > 0 ? "_" : "") + g_batch_axes[axis] + g_batch_values[axis][index[axis]];
+		}
+		run.name = runOutputName(label);
+		runs.push_back(run);
+		for (axis = g_batch_axes.size(); axis > 0; axis--) {
+			if (++index[axis - 1] < g_batch_values[axis - 1].size()) break;
+			index[axis - 1] = 0;
+		}
+	} while (axis > 0);
+	return runs;
+}
+
+/*
+ * Index of a batch: one line per run, with its output name, status
+ * (pending, completed, skipped or failed) and parameter values. It is
+ * rewritten as runs end, so that an interrupted batch can be resumed.
+ */
+static void writeBatchIndex(const string &index_name, const vector<batchRun> &runs, const vector<string> &status) {
+	ofstream index(index_name.c_str(), ios::out | ios::trunc);
+	unsigned int i, j;
+
+	if (!index) {
+		cerr << "Can't open the batch index file: " << index_name << endl;
+		exit(-1);
+	}
+	index << "# Run\tStatus\tParameters" << endl;
+	for (i = 0; i < runs.size(); i++) {
+		index << runs[i].name << "\t" << status[i] << "\t";
+		for (j = 0; j < runs[i].overrides.size(); j++)
+			index << (j > 0 ? " " : "") << runs[i].overrides[j].first << "=" << runs[i].overrides[j].second;
+		index << endl;
+	}
+}
+
+/* Status of the runs recorded by a previous invocation of the same batch */
+static map<string, string> readBatchIndex(const string &index_name) {
+	ifstream index(index_name.c_str());
+	map<string, string> recorded;
+	string line, name, status;
+
+	while (getline(index, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		istringstream fields(line);
+		getline(fields, name, '\t');
+		getline(fields, status, '\t');
+		recorded[name] = status;
+	}
+	return recorded;
+}
+
+/*
+ * The index status of a run prevails, so failed (or interrupted) runs are
+ * simulated again. Runs missing from the index are complete if their text
+ * output exists, as it is only renamed into place once fully written.
+ */
+static bool isRunComplete(const batchRun &run, const map<string, string> &recorded) {
+	map<string, string>::const_iterator it = recorded.find(run.name);
+	struct stat info;
+
+	if (it != recorded.end()) return it->second == "completed" || it->second == "skipped";
+	return g_results_format != JSONL && stat(run.name.c_str(), &info) == 0 && info.st_size > 0;
+}
+
+/* Within a child process, bounds the memory its run may allocate */
+static void limitRunMemory() {
+	struct rlimit limit;
+
+	if (g_batch_memory_limit == 0) return;
+	limit.rlim_cur = limit.rlim_max = g_batch_memory_limit << 20;
+	if (setrlimit(RLIMIT_AS, &limit) != 0) cerr << "ERROR: can't limit the memory of a batch run" << endl;
+}
+
+/*
+ * Simulates every combination of the batch axes in a child process,
+ * keeping up to SweepJobs of them running; each free slot takes the
+ * next pending run, so long and short runs balance out. Runs already
+ * completed (by a previous invocation) are skipped. The batch process
+ * exits once all of them have ended.
+ */
+void runBatch(int argc, char *argv[]) {
+	string index_name = string(g_output_file_name) + ".index";
+	vector<batchRun> runs = batchRuns();
+	vector<string> status(runs.size(), "pending");
+	map<string, string> recorded = readBatchIndex(index_name);
+	unsigned int jobs = sweepJobs(), next = 0, failed = 0, skipped = 0, run;
+	map<pid_t, unsigned int> running;
+	bool success;
+	pid_t pid;
+
+	cout << "Batch over " << g_batch_axes.size() << " parameters: " << runs.size() << " runs, up to " << jobs
+			<< " at a time" << endl;
+	while (next < runs.size() || !running.empty()) {
+		if (next < runs.size() && running.size() < jobs) {
+			if (isRunComplete(runs[next], recorded)) {
+				status[next++] = "skipped";
+				skipped++;
+				continue;
+			}
+			pid = forkRun(NULL);
+			if (pid == 0) {
+				limitRunMemory();
+				execRun(argc, argv, runs[next].name, runs[next].overrides);
+			}
+			running[pid] = next++;
+			continue;
+		}
+
+		run = waitRun(running, success);
+		status[run] = success ? "completed" : "failed";
+		if (success) {
+			cout << "Run " << runs[run].name << " finished" << endl;
+		} else {
+			cerr << "ERROR: run " << runs[run].name << " failed, see " << runs[run].name << ".log" << endl;
+			failed++;
+		}
+		writeBatchIndex(index_name, runs, status);
+	}
+	writeBatchIndex(index_name, runs, status);
+	cout << "Batch finished: " << runs.size() - failed - skipped << " runs completed, " << skipped
+			<< " skipped (already completed), " << failed << " failed; index in " << index_name << endl;
+	exit(failed > 0 ? -1 : 0);
+}
+
+/*
+ * Within a run of a saturation search or a replication, reports its
+ * accepted load, average flit latency and average packet latency back.
+ */
+void reportSweepRun() {
+	long long rx_flits = g_rx_flit_counter - g_rx_warmup_flit_counter;
+	long long rx_packets = g_rx_packet_counter - g_rx_warmup_packet_counter;
+	char line[128];
+	int length;
+
+	if (g_sweep_report_fd < 0) return;
+	length = snprintf(line, sizeof(line), "%.9g %.9g %.9g\n",
+			1.0 * rx_flits * g_flit_size / (1.0 * g_number_generators * (g_cycle - g_warmup_cycles)),
+			(rx_flits > 0) ? (double) (g_flit_latency - g_warmup_flit_latency) / rx_flits : 0,
+			(rx_packets > 0) ? (double) (g_packet_latency - g_warmup_packet_latency) / rx_packets : 0);
+	if (write(g_sweep_report_fd, line, length) != length) cerr << "ERROR: can't report back to the sweep" << endl;
+	close(g_sweep_report_fd);
+	g_sweep_report_fd = -1;
+}
@@ -0,0 +1,57 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SWEEP_H
+#define	SWEEP_H
+
+/*
+ * Sweep mode: a single invocation simulates every value given for one
+ * parameter (SweepKey), running up to SweepJobs of them at a time in
+ * child processes. When the injection probability is swept, network and
+ * parsed inputs are built once and children share them (copy-on-write);
+ * any other parameter may shape the network, so each child starts the
+ * simulator from scratch. Each run writes its results under its own
+ * output name, and its console output into a '.log' file.
+ *
+ * Saturation search is a sweep over the injection probability whose
+ * values are chosen on the fly: every round probes SweepJobs values
+ * evenly spread over the interval known to contain the saturation
+ * point, and narrows it down upon the accepted load reported by each
+ * run, until it is below SaturationTolerance.
+ *
+ * Branching (BranchVariants) forks the child processes once warmup is
+ * over instead, so all variants start from the very same network state.
+ * Each variant overrides some parameters read as simulation runs (see
+ * isBranchParameter()), such as the second pattern of TRANSIENT traffic
+ * or congestion management thresholds.
+ *
+ * Batch mode (BatchAxes) simulates every combination of the values given
+ * for several parameters, each run in a fresh simulator instance, and
+ * keeps an index of their outputs and status. Runs completed by a
+ * previous invocation are skipped, so an interrupted batch resumes.
+ */
+bool sweepSharesNetwork();
+void runSweep(int argc, char *argv[]);
+void reportSweepRun();
+void checkBranchVariants();
+void runBranches();
+void runBatch(int argc, char *argv[]);
+
+#endif	/* SWEEP_H */
@@ -21,6 +21,7 @@
 #include "ageArbiter.h"
 #include "../switchModule.h"
 #include "../../flit/flitModule.h"
+#include "../../checkpoint.h"
 
 ageArbiter::ageArbiter(PortType type, int portNumber, unsigned short cos, int numPorts, switchModule *switchM) :
 		arbiter(type, portNumber, cos, numPorts, switchM) {
@@ -119,3 +120,7 @@ void ageArbiter::markServedPort(int servedPort) {
 	this->arbiter::markServedPort(servedPort);
 }
 
+void ageArbiter::checkpoint(checkpointFile &ckpt) {
+	arbiter::checkpoint(ckpt);
+	ckpt.array(ageList, ports);
+}
@@ -35,6 +35,7 @@ public:
 	int getServingPort(int offset);
 	void markServedPort(int servedPort);
 	virtual void reorderPortList();
+	void checkpoint(checkpointFile &ckpt);
 };
 
 #endif /* class_ageArbiter */
@@ -20,6 +20,7 @@
 
 #include "arbiter.h"
 #include "../switchModule.h"
+#include "../../checkpoint.h"
 
 using namespace std;
 
@@ -112,3 +113,8 @@ void arbiter::markServedPort(int servedPort) {
 	if (type == OUT) return;
 	qcnList[servedPort] = -1;
 }
+
+void arbiter::checkpoint(checkpointFile &ckpt) {
+	ckpt.array(portList, ports);
+	ckpt.array(qcnList, ports);
+}
@@ -27,6 +27,7 @@ using namespace std;
 
 class switchModule;
 class baseRouting;
+class checkpointFile;
 
 class arbiter {
 protected:
@@ -46,6 +47,7 @@ public:
 	virtual void markServedPort(int servedPort);
 	void reorderListQcn();
 	void updateQcn(int servedPort);
+	virtual void checkpoint(checkpointFile &ckpt);
 };
 
 #endif
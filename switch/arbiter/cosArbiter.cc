@@ -21,6 +21,9 @@
 #include "cosArbiter.h"
 #include "../switchModule.h"
 #include "../../flit/flitModule.h"
+#include "../../packetTracer.h"
+#include "../../phaseProfiler.h"
+#include "../../checkpoint.h"
 
 using namespace std;
 
@@ -73,13 +76,17 @@ bool cosArbiter::attendPetition(int input_channel) {
 	if (flit->head == true) {
 		/* First flit of a packet */
 		candidate selectedPath;
+		long long prof_start = profilerStart();
 		if (flit->flitType == CNM)
 			selectedPath = switchM->qcnRouting->enroute(flit, input_port, input_channel);
 		else
 			selectedPath = switchM->routing->enroute(flit, input_port, input_channel);
+		profilerStop(PROF_ROUTING, prof_start);
 		outP = selectedPath.port;
 		outVC = selectedPath.vc;
 		nextP = selectedPath.neighPort;
+		if (g_packet_trace)
+			g_packet_tracer->record(PKT_ROUTE, switchM->label, flit, input_port, input_channel, outP, outVC);
 	} else {
 		/* Body flit of a packet: forward it to the assigned output
 		 * port (remember routing is done in a per-packet basis) */
@@ -96,6 +103,8 @@ bool cosArbiter::attendPetition(int input_channel) {
 		flit->nextP = outP;
 		flit->nextVC = outVC;
 		result = true;
+		if (g_packet_trace)
+			g_packet_tracer->record(PKT_VC_ALLOC, switchM->label, flit, input_port, input_channel, outP, outVC);
 	} else {
 		/* Petition can NOT be made */
 		switchM->outputArbiters[outP]->petitions[input_port] = 0;
@@ -205,3 +214,7 @@ int cosArbiter::action() {
 	}
 	return attendedPort;
 }
+
+void cosArbiter::checkpoint(checkpointFile &ckpt) {
+	arbProtocol->checkpoint(ckpt);
+}
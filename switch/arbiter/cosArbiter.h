@@ -42,6 +42,7 @@ public:
 	~cosArbiter();
 	int action();
 	bool portCanSendFlit(int port, unsigned short cos, int vc);
+	void checkpoint(checkpointFile &ckpt);
 
 private:
 	arbiter *arbProtocol;
@@ -21,6 +21,7 @@
 #include "inputArbiter.h"
 #include "../switchModule.h"
 #include "../../flit/flitModule.h"
+#include "../../checkpoint.h"
 
 using namespace std;
 
@@ -89,3 +90,9 @@ int inputArbiter::action() {
 	}
 	return attendedPort;
 }
+
+void inputArbiter::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(curCos);
+	for (int i = 0; i < cosLevels; i++)
+		cosArbiters[i]->checkpoint(ckpt);
+}
@@ -36,6 +36,7 @@ public:
 	int action();
 	bool checkPort();
 	unsigned short getCurCos();
+	void checkpoint(checkpointFile &ckpt);
 
 private:
 	unsigned short cosLevels;
@@ -21,6 +21,7 @@
 #include "outputArbiter.h"
 #include "../switchModule.h"
 #include "../ioqSwitchModule.h"
+#include "../../checkpoint.h"
 
 using namespace std;
 
@@ -154,3 +155,13 @@ int outputArbiter::action() {
 	}
 	return attendedPort;
 }
+
+void outputArbiter::checkpoint(checkpointFile &ckpt) {
+	int ports = arbProtocol->ports;
+	ckpt.array(petitions, ports);
+	ckpt.array(nextPorts, ports);
+	ckpt.array(nextChannels, ports);
+	ckpt.array(inputChannels, ports);
+	ckpt.array(inputCos, ports);
+	arbProtocol->checkpoint(ckpt);
+}
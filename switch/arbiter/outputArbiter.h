@@ -44,6 +44,7 @@ public:
 	int action();
 	void initPetitions();
 	bool checkPort();
+	void checkpoint(checkpointFile &ckpt);
 
 private:
 	arbiter *arbProtocol;
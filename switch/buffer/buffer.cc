@@ -21,6 +21,7 @@
 #include "buffer.h"
 #include "../../dgflySimulator.h"
 #include "../switchModule.h"
+#include "../../checkpoint.h"
 
 using namespace std;
 
@@ -179,3 +180,26 @@ bool buffer::isBufferSending() {
 	}
 	return false;
 }
+
+/*
+ * Stores (or restores) the buffer contents, along with
+ * the locks and timing of the packet being sent.
+ */
+void buffer::checkpoint(checkpointFile &ckpt) {
+	ckpt.array(bufferEntryCycle, bufferCapacity + 1);
+	for (int j = 0; j <= bufferCapacity; j++)
+		ckpt.flit(bufferContent[j]);
+	ckpt.value(head);
+	ckpt.value(tail);
+	ckpt.value(lastExtractCycle);
+	ckpt.value(txLength);
+	ckpt.value(m_portLock);
+	ckpt.value(m_vcLock);
+	ckpt.value(m_pktLock);
+	ckpt.value(m_unLocked);
+	ckpt.value(m_outPort_currentPkt);
+	ckpt.value(m_nextVC_currentPkt);
+	ckpt.value(m_currentPkt);
+	ckpt.value(lastReceiveCycle);
+	ckpt.value(escapeBuffer);
+}
@@ -26,6 +26,7 @@
 using namespace std;
 class flitModule;
 class switchModule;
+class checkpointFile;
 
 class buffer {
 protected:
@@ -66,6 +67,7 @@ public:
 	void reorderBuffer();
 	float getDelay() const;
 	float getHeadEntryCycle();
+	void checkpoint(checkpointFile &ckpt);
 };
 
 #endif
@@ -19,6 +19,9 @@
  */
 
 #include "ioqSwitchModule.h"
+#include "../packetTracer.h"
+#include "../phaseProfiler.h"
+#include "../checkpoint.h"
 #include <iomanip>
 
 ioqSwitchModule::ioqSwitchModule(string name, int label, int aPos, int hPos, int ports, int vcCount) :
@@ -92,11 +95,14 @@ ioqSwitchModule::~ioqSwitchModule() {
 
 void ioqSwitchModule::action() {
 	int port, vc;
+	long long prof_start;
 	g_internal_cycle = g_cycle;
 
 	switchModule::action();
+	prof_start = profilerStart();
 	for (port = 0; port < this->portCount; port++)
 		updateOutputBuffer(port);
+	profilerStop(PROF_OUTPUT_BUFFER, prof_start);
 	for (port = 0; port < this->portCount; port++)
 		outPorts[port]->reorderBuffer(0);
 
@@ -348,6 +354,8 @@ void ioqSwitchModule::xbarTraversal(int input_port, unsigned short cos, int inpu
 	assert(length <= g_flit_size);
 
 	assert(inPorts[input_port]->extract(cos, input_channel, flitEx, length));
+	if (g_packet_trace)
+		g_packet_tracer->record(PKT_XBAR, this->label, flitEx, input_port, input_channel, outP, nextC);
 
 	/* Contention-Aware misrouting trigger notification */
 	if (g_contention_aware && g_increaseContentionAtHeader) {
@@ -554,3 +562,9 @@ void ioqSwitchModule::qcnOccupancySampling(int port) {
 		// base implementation of sampling
 		switchModule::qcnOccupancySampling(port);
 }
+
+void ioqSwitchModule::checkpoint(checkpointFile &ckpt) {
+	switchModule::checkpoint(ckpt);
+	ckpt.array(lastCheckedOutBuffer, this->portCount);
+	ckpt.value(m_internal_cycle);
+}
@@ -46,6 +46,7 @@ public:
 	ioqSwitchModule(string name, int label, int aPos, int hPos, int ports, int vcCount);
 	~ioqSwitchModule();
 	void action();
+	void checkpoint(checkpointFile &ckpt);
 };
 
 #endif
@@ -20,6 +20,7 @@
 
 #include "bufferedOutPort.h"
 #include "../switchModule.h"
+#include "../../checkpoint.h"
 
 bufferedOutPort::bufferedOutPort(unsigned short cosLevels, int numVCs, int portNumber, int bufferNumber,
 		int bufferCapacity, float delay, switchModule * sw, int reservedBufferCapacity, int numberSegregatedFlows) :
@@ -194,3 +195,17 @@ void bufferedOutPort::reorderBuffer(int vc) {
 		this->bufferedPort::reorderBuffer(cosOutPort, buffer);
 	}
 }
+
+void bufferedOutPort::checkpoint(checkpointFile &ckpt) {
+	outPort::checkpoint(ckpt);
+	bufferedPort::checkpoint(ckpt);
+	for (int cos = 0; cos < outPort::cosLevels; cos++) {
+		for (int vc = 0; vc < outPort::numVCs; vc++) {
+			ckpt.array(outCredits[cos][vc], numberSegregatedFlows);
+			ckpt.array(outMinCredits[cos][vc], numberSegregatedFlows);
+			ckpt.array(maxOutCredits[cos][vc], numberSegregatedFlows);
+		}
+	}
+	ckpt.value(numConsumePetitions);
+	ckpt.value(totalMaxOutCredits);
+}
@@ -54,6 +54,7 @@ public:
 	bool canSendFlit(unsigned short cos, int vc, int buffer = 0);
 	bool canReceiveFlit(int vc);
 	void reorderBuffer(int vc);
+	void checkpoint(checkpointFile &ckpt);
 
 };
 
@@ -19,6 +19,7 @@
  */
 
 #include "bufferedPort.h"
+#include "../../checkpoint.h"
 
 bufferedPort::bufferedPort(unsigned short cosLevels, int numVCs, int bufferNumber, int bufferCapacity, float delay,
 		int reservedBufferCapacity) {
@@ -215,3 +216,10 @@ void bufferedPort::setUnlocked(unsigned short cos, int vc, int unlocked) {
 	if (vc >= this->numVCs) return;
 	vcBuffers[cos][vc]->m_unLocked = unlocked;
 }
+
+void bufferedPort::checkpoint(checkpointFile &ckpt) {
+	ckpt.value(aggregatedBufferCapacity);
+	for (int cos = 0; cos < this->cosLevels; cos++)
+		for (int vc = 0; vc < this->numVCs; vc++)
+			this->vcBuffers[cos][vc]->checkpoint(ckpt);
+}
@@ -60,6 +60,7 @@ public:
 	void setPortPktLock(unsigned short cos, int vc, int port);
 	void setVcPktLock(unsigned short cos, int vc, int prevVc);
 	void setUnlocked(unsigned short cos, int vc, int unlocked);
+	void checkpoint(checkpointFile &ckpt);
 };
 
 #endif /* BUFFERED_PORT_H_ */
@@ -21,6 +21,7 @@
 #include "outPort.h"
 #include "../../dgflySimulator.h"
 #include "../switchModule.h"
+#include "../../checkpoint.h"
 
 outPort::outPort(unsigned short cosLevels, int numVCs, int portNumber, switchModule * sw) :
 		port(cosLevels, numVCs, portNumber, sw) {
@@ -138,3 +139,11 @@ void outPort::decreaseOccupancy(unsigned short cos, int vc, int phits) {
 	occupancyCredits[cos][vc] -= phits;
 	assert(occupancyCredits[cos][vc] >= 0);
 }
+
+void outPort::checkpoint(checkpointFile &ckpt) {
+	for (int cos = 0; cos < this->cosLevels; cos++) {
+		ckpt.array(this->occupancyCredits[cos], this->numVCs);
+		ckpt.array(this->minOccupancyCredits[cos], this->numVCs);
+		ckpt.array(this->maxCredits[cos], this->numVCs);
+	}
+}
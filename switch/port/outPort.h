@@ -43,6 +43,7 @@ public:
 	void increaseOccupancy(unsigned short cos, int vc, int phits);
 	void decreaseOccupancy(unsigned short cos, int vc, int phits);
 	void decreaseMinOccupancy(unsigned short cos, int vc, int phits);
+	virtual void checkpoint(checkpointFile &ckpt);
 
 	/* Added for bufferedOutPort compatibility */
 	virtual void setMaxOutOccupancy(unsigned short cos, int vc, int phits) {
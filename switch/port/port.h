@@ -25,6 +25,7 @@
 
 class switchModule;
 class flitModule;
+class checkpointFile;
 
 using namespace std;
 
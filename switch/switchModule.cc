@@ -40,6 +40,9 @@
 #include "../routing/routing.h"
 #include "../switch/vcManagement/qcnVcMngmt.h"
 #include <iomanip>
+#include "../packetTracer.h"
+#include "../phaseProfiler.h"
+#include "../checkpoint.h"
 
 switchModule::switchModule(string name, int label, int aPos, int hPos, int ports, int vcCount) :
 		piggyBack(aPos), m_ca_handler(this) {
@@ -479,6 +482,15 @@ int switchModule::getTotalFreeSpace() {
 
 }
 
+int switchModule::getTotalOccupancy() {
+	int p, cos, c, totalOccupancy = 0;
+	for (p = 0; p < portCount; p++)
+		for (cos = 0; cos < cosLevels; cos++)
+			for (c = 0; c < vcCount; c++)
+				totalOccupancy = totalOccupancy + inPorts[p]->getBufferOccupancy(cos, c);
+	return (totalOccupancy);
+}
+
 /*
  * Insert flit into a buffer. Used in TRANSIT.
  * Credit count reduction is done in the upstream switch, not here.
@@ -511,6 +523,7 @@ void switchModule::injectFlit(int port, int vc, flitModule * flit) {
 	else
 		g_tx_flit_counter++;
 	inPorts[port]->insert(vc, flit, g_flit_size);
+	if (g_packet_trace) g_packet_tracer->record(PKT_INJECT, this->label, flit, port, vc, -1, -1);
 
 	/* Calculate message's base latency and record it. */
 	base_latency = calculateBaseLatency(flit);
@@ -646,12 +659,19 @@ void switchModule::action() {
 	int p, in_ports_count, out_ports_count, vc, in_req, max_reqs;
 	unsigned short cos;
 	flitModule *flit = NULL;
+	long long prof_start;
 
 	max_reqs = g_issue_parallel_reqs ? g_local_arbiter_speedup : 1;
 
+	prof_start = profilerStart();
 	updateCredits();
+	profilerStop(PROF_CREDITS, prof_start);
 
-	if (g_routing == PB || g_routing == PB_ANY || g_routing == SRC_ADP || g_routing == PB_ACOR) updatePb();
+	if (g_routing == PB || g_routing == PB_ANY || g_routing == SRC_ADP || g_routing == PB_ACOR) {
+		prof_start = profilerStart();
+		updatePb();
+		profilerStop(PROF_PIGGYBACKING, prof_start);
+	}
 
     if ((g_routing == ACOR || g_routing == PB_ACOR) && 
             (g_acor_state_management == SWITCHCGCSRS || g_acor_state_management == SWITCHCGRS ||
@@ -670,7 +690,11 @@ void switchModule::action() {
             g_acor_group0_sws_status[label][g_cycle] = acorSwStatus;
     }
 
-	if (g_contention_aware && g_increaseContentionAtHeader) m_ca_handler.update();
+	if (g_contention_aware && g_increaseContentionAtHeader) {
+		prof_start = profilerStart();
+		m_ca_handler.update();
+		profilerStop(PROF_CONTENTION, prof_start);
+	}
 
 	if (g_vc_misrouting_congested_restriction) this->routing->updateCongestionStatusGlobalLinks();
 
@@ -716,6 +740,7 @@ void switchModule::action() {
 
 		int inputArbitersPortCount = (g_congestion_management == QCNSW) ? this->portCount + 1 : this->portCount;
 		/* Input arbiters execution */
+		prof_start = profilerStart();
 		for (in_ports_count = 0; in_ports_count < inputArbitersPortCount; in_ports_count++) {
 			/* Reset reserved_port trackers */
 			for (p = 0; p < this->portCount; p++)
@@ -747,9 +772,12 @@ void switchModule::action() {
 				}
 			}
 		}
+		profilerStop(PROF_INPUT_ARBITRATION, prof_start);
 		/* Output arbiters execution */
 		for (out_ports_count = 0; out_ports_count < this->portCount; out_ports_count++) {
+			prof_start = profilerStart();
 			in_ports_count = this->outputArbiters[out_ports_count]->action();
+			profilerStop(PROF_OUTPUT_ARBITRATION, prof_start);
 			if (in_ports_count != -1) {
 				// Attends petition (consumes packet or sends it through 'sendFlit')
 				vc = this->outputArbiters[out_ports_count]->inputChannels[in_ports_count];
@@ -781,8 +809,10 @@ void switchModule::action() {
 					// Reset counter for setting timer
 					qcnRpTxBCount[in_ports_count] = g_qcn_bc_limit;
 				}
+				prof_start = profilerStart();
 				xbarTraversal(in_ports_count, cos, vc, out_ports_count, routing->neighPort[out_ports_count],
 						this->outputArbiters[out_ports_count]->nextChannels[in_ports_count]);
+				profilerStop(PROF_XBAR, prof_start);
 			}
 		}
 	}
@@ -1252,6 +1282,8 @@ void switchModule::xbarTraversal(int input_port, unsigned short cos, int input_c
 	inPorts[input_port]->checkFlit(cos, input_channel, flitEx);
 	assert(inPorts[input_port]->canSendFlit(cos, input_channel));
 	assert(inPorts[input_port]->extract(cos, input_channel, flitEx, g_flit_size));
+	if (g_packet_trace)
+		g_packet_tracer->record(PKT_XBAR, this->label, flitEx, input_port, input_channel, outP, nextC);
 
 	if (g_contention_aware && (!g_increaseContentionAtHeader)) {
 		m_ca_handler.decreaseContention(routing->minOutputPort(flitEx->destId));
@@ -1731,3 +1763,86 @@ void switchModule::acorDecState() {
     }
     assert(acorSwStatus >= CRGLGr && acorSwStatus <= RRGLSw);
 }
+
+/*
+ * Stores (or restores) the switch state: ports with their buffers and
+ * the flits within, arbiters, credits and piggybacking/contention
+ * messages still on flight, routing state and switch statistics.
+ */
+void switchModule::checkpoint(checkpointFile &ckpt) {
+	int p, cos;
+	long long i, size;
+
+	for (p = 0; p < portCount; p++) {
+		inPorts[p]->checkpoint(ckpt);
+		outPorts[p]->checkpoint(ckpt);
+		inputArbiters[p]->checkpoint(ckpt);
+		outputArbiters[p]->checkpoint(ckpt);
+		size = incomingCredits[p]->size();
+		ckpt.value(size);
+		for (i = 0; i < size; i++) {
+			creditFlit crdFlit(0, 0, 0, 0, 0, 0);
+			if (!ckpt.isRestoring()) {
+				crdFlit = incomingCredits[p]->front();
+				incomingCredits[p]->pop();
+			}
+			crdFlit.checkpoint(ckpt);
+			incomingCredits[p]->push(crdFlit);
+		}
+	}
+
+	/* PiggyBacking and contention messages are copied in and out of the queues, as they own their arrays */
+	size = incomingPb.size();
+	ckpt.value(size);
+	for (i = 0; i < size; i++) {
+		if (ckpt.isRestoring()) {
+			pbFlit *flit = piggyBack.createFlit(0);
+			flit->checkpoint(ckpt);
+			incomingPb.push(*flit);
+			delete flit;
+		} else {
+			pbFlit flit(incomingPb.front());
+			incomingPb.pop();
+			flit.checkpoint(ckpt);
+			incomingPb.push(flit);
+		}
+	}
+	size = incomingCa.size();
+	ckpt.value(size);
+	for (i = 0; i < size; i++) {
+		if (ckpt.isRestoring()) {
+			vector<int> counter(g_a_routers_per_group * g_h_global_ports_per_router + 1, 0);
+			caFlit flit(aPos, counter.data(), 0);
+			flit.checkpoint(ckpt);
+			incomingCa.push(flit);
+		} else {
+			caFlit flit(incomingCa.front());
+			incomingCa.pop();
+			flit.checkpoint(ckpt);
+			incomingCa.push(flit);
+		}
+	}
+	piggyBack.checkpoint(ckpt);
+	m_ca_handler.checkpoint(ckpt);
+	routing->checkpoint(ckpt);
+
+	ckpt.value(acorSwStatus);
+	ckpt.value(acor_hyst_cycles_counter);
+	ckpt.value(acor_inc_state_th_packets);
+	ckpt.value(acor_dec_state_th_packets);
+	ckpt.value(acor_packets_blocked_counter);
+	ckpt.value(messagesInQueuesCounter);
+	ckpt.value(escapeNetworkCongested);
+	ckpt.value(packetsInj);
+	ckpt.value(cnmPacketsInj);
+	ckpt.array(queueOccupancy, portCount * vcCount);
+	ckpt.array(injectionQueueOccupancy, vcCount);
+	ckpt.array(localQueueOccupancy, vcCount);
+	ckpt.array(globalQueueOccupancy, vcCount);
+	ckpt.array(localEscapeQueueOccupancy, vcCount);
+	ckpt.array(globalEscapeQueueOccupancy, vcCount);
+	ckpt.value(outputQueueOccupancy);
+	ckpt.array(reservedOutPort, portCount);
+	for (cos = 0; cos < cosLevels; cos++)
+		ckpt.array(reservedInPort[cos], vcCount);
+}
@@ -105,6 +105,7 @@ public:
 	virtual ~switchModule();
 	int getTotalCapacity();
 	int getTotalFreeSpace();
+	int getTotalOccupancy();
 	void insertFlit(int port, int vc, flitModule *flit);
 	virtual int getCredits(int port, unsigned short cos, int channel);
 	virtual int getCreditsOccupancy(int port, unsigned short cos, int channel, int buffer = 0);
@@ -141,6 +142,7 @@ public:
 	void resetQueueOccupancy();
 	void setQueueOccupancy();
 	void action();
+	virtual void checkpoint(checkpointFile &ckpt);
 
 	short int getPortEnrouteMinimalProbability(int port);
 
@@ -20,11 +20,13 @@
 
 #include "tbFlexVc.h"
 #include "../switchModule.h"
+#include "../../memoryPlanner.h"
 
 /* Table-based FlexVC determines the VC through minimal and nonminimal tables set up at the start of the execution. */
 tbFlexVc::tbFlexVc(vector<portClass> * hopSeq, switchModule * switchM) {
 	this->switchM = switchM;
 	typeVc = *hopSeq;
+	tableResVcSwMin = tableResVcGroupMin = tableResVcSwNonmin = tableResVcGroupNonmin = NULL;
 
 	/* Check if the routing has opportunistic hops or not in order to set up the tables */
 	int minLocalVCs = 0, minGlobalVCs = 0, numOppLocHops = 0, numOppGlobHops = 0;
@@ -71,28 +73,19 @@ tbFlexVc::tbFlexVc(vector<portClass> * hopSeq, switchModule * switchM) {
 		}
 	}
 
-	/* Set up the tables for minimal/nonminimal routes */
-	int destH, destSw, destP;
-	this->tableVcGroupMin = new short[g_a_routers_per_group * g_h_global_ports_per_router + 1];
-	this->tableVcGroupNonmin = new short[g_a_routers_per_group * g_h_global_ports_per_router + 1];
-	for (destH = 0; destH < (g_h_global_ports_per_router * g_a_routers_per_group + 1); destH++) {
-		if (destH == switchM->hPos) {
-			this->tableVcGroupMin[destH] = -1;
-			continue;
-		}
+	/* Set up the tables for minimal/nonminimal routes. Group tables are indexed by the offset of the dest group
+	 * (see groupOffset()), so they only depend on the position of the switch within its group */
+	int offsetH, destSw, destP, groups = g_a_routers_per_group * g_h_global_ports_per_router;
+	this->tableVcGroupMin = new short[groups];
+	this->tableVcGroupNonmin = new short[groups];
+	for (offsetH = 0; offsetH < groups; offsetH++) {
 		/* Determine if the minimal path to the dest group is through a local or global link */
-		int offsetH;
-		if (g_palm_tree_configuration)
-			offsetH = module((switchM->hPos - destH), (g_a_routers_per_group * g_h_global_ports_per_router + 1)) - 1;
-		else
-			offsetH = (destH > switchM->hPos) ? destH - 1 : destH;
-
 		if (int(offsetH / g_h_global_ports_per_router) == switchM->aPos) { /* Global port */
-			this->tableVcGroupMin[destH] = short(globalVc.back());
-			this->tableVcGroupNonmin[destH] = short(globalVc.front());
+			this->tableVcGroupMin[offsetH] = short(globalVc.back());
+			this->tableVcGroupNonmin[offsetH] = short(globalVc.front());
 		} else { /* Local port */
-			this->tableVcGroupMin[destH] = short(localVcDest.at(localVcDest.size() - 2));
-			this->tableVcGroupNonmin[destH] = short(localVcDest.front());
+			this->tableVcGroupMin[offsetH] = short(localVcDest.at(localVcDest.size() - 2));
+			this->tableVcGroupNonmin[offsetH] = short(localVcDest.front());
 		}
 	}
 	this->tableVcSwMin = new short[g_a_routers_per_group];
@@ -166,27 +159,16 @@ tbFlexVc::tbFlexVc(vector<portClass> * hopSeq, switchModule * switchM) {
 		assert(globalResVc.size() == minGlobalVCs && localResVcDest.size() == minLocalVCs);
 
 		/* Set up the tables for minimal/nonminimal routes */
-		this->tableResVcGroupMin = new short[g_a_routers_per_group * g_h_global_ports_per_router + 1];
-		this->tableResVcGroupNonmin = new short[g_a_routers_per_group * g_h_global_ports_per_router + 1];
-		for (destH = 0; destH < ((g_h_global_ports_per_router * g_a_routers_per_group) + 1); destH++) {
-			if (destH == switchM->hPos) {
-				this->tableResVcGroupMin[destH] = -1;
-				continue;
-			}
+		this->tableResVcGroupMin = new short[groups];
+		this->tableResVcGroupNonmin = new short[groups];
+		for (offsetH = 0; offsetH < groups; offsetH++) {
 			/* Determine if the minimal path to the dest group is through a local or global link */
-			int offsetH;
-			if (g_palm_tree_configuration)
-				offsetH = module((switchM->hPos - destH), (g_a_routers_per_group * g_h_global_ports_per_router + 1))
-						- 1;
-			else
-				offsetH = (destH > switchM->hPos) ? destH - 1 : destH;
-
 			if (int(offsetH / g_h_global_ports_per_router) == switchM->aPos) { /* Global port */
-				this->tableResVcGroupMin[destH] = globalResVc.back();
-				this->tableResVcGroupNonmin[destH] = globalResVc.front();
+				this->tableResVcGroupMin[offsetH] = globalResVc.back();
+				this->tableResVcGroupNonmin[offsetH] = globalResVc.front();
 			} else { /* Local port */
-				this->tableResVcGroupMin[destH] = localResVcDest.at(localResVcDest.size() - 2);
-				this->tableResVcGroupNonmin[destH] = localResVcDest.front();
+				this->tableResVcGroupMin[offsetH] = localResVcDest.at(localResVcDest.size() - 2);
+				this->tableResVcGroupNonmin[offsetH] = localResVcDest.front();
 			}
 		}
 
@@ -217,17 +199,27 @@ tbFlexVc::tbFlexVc(vector<portClass> * hopSeq, switchModule * switchM) {
 				localResVcDest.insert(localResVcDest.begin() + petLocalVCs, vc);
 		}
 	}
+
+	/* Tables are complete, so they can be shared among switches in compact mode */
+	tableVcSwMin = shareTable(tableVcSwMin, g_a_routers_per_group);
+	tableVcSwNonmin = shareTable(tableVcSwNonmin, g_a_routers_per_group);
+	tableVcGroupMin = shareTable(tableVcGroupMin, groups);
+	tableVcGroupNonmin = shareTable(tableVcGroupNonmin, groups);
+	tableResVcSwMin = shareTable(tableResVcSwMin, g_a_routers_per_group);
+	tableResVcSwNonmin = shareTable(tableResVcSwNonmin, g_a_routers_per_group);
+	tableResVcGroupMin = shareTable(tableResVcGroupMin, groups);
+	tableResVcGroupNonmin = shareTable(tableResVcGroupNonmin, groups);
 }
 
 tbFlexVc::~tbFlexVc() {
-	delete[] tableVcSwMin;
-	delete[] tableVcGroupMin;
-	delete[] tableVcSwNonmin;
-	delete[] tableVcGroupNonmin;
-	delete[] tableResVcSwMin;
-	delete[] tableResVcGroupMin;
-	delete[] tableResVcSwNonmin;
-	delete[] tableResVcGroupNonmin;
+	releaseTable(tableVcSwMin);
+	releaseTable(tableVcGroupMin);
+	releaseTable(tableVcSwNonmin);
+	releaseTable(tableVcGroupNonmin);
+	releaseTable(tableResVcSwMin);
+	releaseTable(tableResVcGroupMin);
+	releaseTable(tableResVcSwNonmin);
+	releaseTable(tableResVcGroupNonmin);
 	globalVc.clear();
 	localVcDest.clear();
 	globalResVc.clear();
@@ -263,7 +255,7 @@ int tbFlexVc::nextChannel(int inP, int outP, flitModule * flit) {
 		if (outP == switchM->routing->minOutputPort(flit->destId)
 				&& (flit->getCurrentMisrouteType() != VALIANT || flit->valNodeReached)) {
 			if (flit->destGroup != switchM->hPos) /* Dest in other group */
-				highestVc = this->tableResVcGroupMin[flit->destGroup];
+				highestVc = this->tableResVcGroupMin[groupOffset(switchM->hPos, flit->destGroup)];
 			else
 				highestVc = this->tableResVcSwMin[flit->destSwitch % g_a_routers_per_group];
 		} else {
@@ -271,7 +263,7 @@ int tbFlexVc::nextChannel(int inP, int outP, flitModule * flit) {
 			int valSw = int(flit->valId / g_p_computing_nodes_per_router);
 			int valGroup = int(valSw / g_a_routers_per_group);
 			if (valGroup != switchM->hPos) /* Valiant dest in other group */
-				highestVc = this->tableResVcGroupNonmin[valGroup];
+				highestVc = this->tableResVcGroupNonmin[groupOffset(switchM->hPos, valGroup)];
 			else
 				highestVc = this->tableResVcSwNonmin[valSw % g_a_routers_per_group];
 		}
@@ -280,7 +272,7 @@ int tbFlexVc::nextChannel(int inP, int outP, flitModule * flit) {
 		if (outP == switchM->routing->minOutputPort(flit->destId)
 				&& (flit->getCurrentMisrouteType() != VALIANT || flit->valNodeReached)) {
 			if (flit->destGroup != switchM->hPos) /* Dest in other group */
-				highestVc = this->tableVcGroupMin[flit->destGroup];
+				highestVc = this->tableVcGroupMin[groupOffset(switchM->hPos, flit->destGroup)];
 			else
 				highestVc = this->tableVcSwMin[flit->destSwitch % g_a_routers_per_group];
 		} else {
@@ -288,7 +280,7 @@ int tbFlexVc::nextChannel(int inP, int outP, flitModule * flit) {
 			int valSw = int(flit->valId / g_p_computing_nodes_per_router);
 			int valGroup = int(valSw / g_a_routers_per_group);
 			if (valGroup != switchM->hPos) /* Valiant dest in other group */
-				highestVc = this->tableVcGroupNonmin[valGroup];
+				highestVc = this->tableVcGroupNonmin[groupOffset(switchM->hPos, valGroup)];
 			else
 				highestVc = this->tableVcSwNonmin[valSw % g_a_routers_per_group];
 		}
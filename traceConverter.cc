@@ -0,0 +1,68 @@
+/*
+ FOGSim, simulator for interconnection networks.
+ http://fuentesp.github.io/fogsim/
+ Copyright (C) 2014-2021 University of Cantabria
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "dgflySimulator.h"
+
+/*
+ * Offline trace converter. Takes the same arguments as a simulation run
+ * (config file plus optional overrides) and saves every trace in it as a
+ * binary trace, '<trcFile>.ftrc', with events already translated upon the
+ * PCF file and the packet/phit size and CPU parameters in use. Binary
+ * traces can be then used as 'trcFile' in simulations with the same
+ * parameters, and are mapped into memory with no parsing.
+ *
+ * Parsed events are streamed through a spill file next to the output, so
+ * only CONVERT_BUFFER_EVENTS of them are held in memory at any time.
+ */
+#ifndef CONVERT_BUFFER_EVENTS
+#define CONVERT_BUFFER_EVENTS (1 << 20)
+#endif
+
+int main(int argc, char *argv[]) {
+	int i;
+
+	if (argc < 2) {
+		cerr << "Usage: " << argv[0] << " A_Configuration_File [Parameter=Value ...]" << endl;
+		exit(-1);
+	}
+	readConfiguration(argc, argv);
+	if (g_traffic != TRACE) {
+		cerr << "Configuration file does not specify a TRACE traffic" << endl;
+		exit(-1);
+	}
+
+	for (i = 0; i < g_num_traces; i++) {
+		string binary_file_name(g_trace_file[i]);
+		binary_file_name.append(".ftrc");
+		string spill_file_name(binary_file_name);
+		spill_file_name.append(".tmp");
+		traceProgram *program = compile_trace(i, spill_file_name.c_str(), CONVERT_BUFFER_EVENTS);
+		if (program->isMapped()) {
+			cout << g_trace_file[i] << " is already a binary trace" << endl;
+		} else {
+			program->writeBinary(binary_file_name.c_str());
+			cout << g_trace_file[i] << " -> " << binary_file_name << " (" << program->getNumTasks() << " tasks, "
+					<< program->getNumEvents() << " events)" << endl;
+		}
+		delete program;
+	}
+
+	return 0;
+}